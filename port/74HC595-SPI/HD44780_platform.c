@@ -0,0 +1,233 @@
+/**
+ **********************************************************************************
+ * @file   HD44780_platform.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  This file contains the platform specific functions for HD44780 driver
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "HD44780_platform.h"
+#include <stddef.h>
+
+
+/* Private Macro ----------------------------------------------------------------*/
+#define HD44780_SR_DATA_MASK  (0x0F << HD44780_SR_D4_BIT)
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static void
+SR_Send(HD44780_Platform_t *Platform)
+{
+  if (Platform->Count)
+  {
+    Platform->SpiWrite(Platform->SpiContext, Platform->Buffer, Platform->Count);
+    Platform->Count = 0;
+  }
+}
+
+static void
+SR_Emit(HD44780_Platform_t *Platform, uint8_t Image)
+{
+  if (Platform->Count >= Platform->Size)
+    SR_Send(Platform);
+
+  Platform->Buffer[Platform->Count++] = Image;
+  Platform->Latched = Image;
+}
+
+static void
+SR_SetBit(HD44780_Platform_t *Platform, uint8_t Bit, uint8_t Level)
+{
+  if (Level)
+    Platform->Image |= (1 << Bit);
+  else
+    Platform->Image &= ~(1 << Bit);
+}
+
+
+static void
+PlatformInitRsRwE(void *Context)
+{
+  HD44780_Platform_t *Platform = (HD44780_Platform_t *)Context;
+
+  Platform->Count = 0;
+  Platform->Image = 0;
+  SR_Emit(Platform, Platform->Image);
+}
+
+static void
+PlatformSetValRs(void *Context, uint8_t Level)
+{
+  SR_SetBit((HD44780_Platform_t *)Context, HD44780_SR_RS_BIT, Level);
+}
+
+static void
+PlatformSetValRw(void *Context, uint8_t Level)
+{
+  // RW is tied to GND
+  (void)Context;
+  (void)Level;
+}
+
+static void
+PlatformSetValE(void *Context, uint8_t Level)
+{
+  HD44780_Platform_t *Platform = (HD44780_Platform_t *)Context;
+
+  // RS and data must be stable before the rising edge of E
+  if (Level && Platform->Image != Platform->Latched)
+    SR_Emit(Platform, Platform->Image);
+
+  SR_SetBit(Platform, HD44780_SR_E_BIT, Level);
+  SR_Emit(Platform, Platform->Image);
+}
+
+static void
+PlatformSetDirData(void *Context, uint8_t Dir)
+{
+  // Data pins are always outputs
+  (void)Context;
+  (void)Dir;
+}
+
+static void
+PlatformWriteData(void *Context, uint8_t Data)
+{
+  HD44780_Platform_t *Platform = (HD44780_Platform_t *)Context;
+
+  Platform->Image = (Platform->Image & ~HD44780_SR_DATA_MASK) |
+                    (((Data >> 4) << HD44780_SR_D4_BIT) & HD44780_SR_DATA_MASK);
+}
+
+static void
+PlatformDelayMs(void *Context, uint16_t Delay)
+{
+  HD44780_Platform_t *Platform = (HD44780_Platform_t *)Context;
+
+  SR_Send(Platform);
+  Platform->DelayMs(Delay);
+}
+
+static void
+PlatformDelayUs(void *Context, uint16_t Delay)
+{
+  HD44780_Platform_t *Platform = (HD44780_Platform_t *)Context;
+  uint32_t pad;
+
+  // Nothing is waiting to be sent, a plain delay is enough
+  if (Platform->Count == 0)
+  {
+    Platform->DelayUs(Delay);
+    return;
+  }
+
+  // The next byte is latched one byte time after the last one anyway
+  pad = ((uint32_t)Delay * 1000 + Platform->ByteNs - 1) / Platform->ByteNs;
+  if (pad)
+    pad--;
+
+  if (pad > HD44780_SR_PAD_MAX || pad > Platform->Size)
+  {
+    SR_Send(Platform);
+    Platform->DelayUs(Delay);
+    return;
+  }
+
+  if (Platform->Count + pad > Platform->Size)
+    SR_Send(Platform);
+
+  for (; pad > 0; pad--)
+    SR_Emit(Platform, Platform->Latched);
+}
+
+static void
+PlatformFlush(void *Context)
+{
+  SR_Send((HD44780_Platform_t *)Context);
+}
+
+
+static const HD44780_OPS_SPACE HD44780_Ops_t HD44780_PlatformOps =
+{
+  PlatformInitRsRwE,
+  PlatformSetValRs,
+  PlatformSetValRw,
+  PlatformSetValE,
+  PlatformSetDirData,
+  PlatformWriteData,
+  NULL, // write only
+  PlatformDelayMs,
+  PlatformDelayUs,
+  PlatformFlush,
+  NULL  // deadlines would expire before buffered bytes are sent
+};
+
+
+
+/**
+ ==================================================================================
+                         ##### Public Functions #####                              
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize platform device to communicate HD44780 through a 74HC595.
+ * @note   Platform must remain valid while the handler is in use. The SPI
+ *         peripheral must be initialized by user.
+ * @param  Handler: Pointer to handler
+ * @param  Platform: Pointer to shift register transport
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Invalid parameters.
+ */
+HD44780_Result_t
+HD44780_Platform_Init(HD44780_Handler_t *Handler, HD44780_Platform_t *Platform)
+{
+  uint32_t byteNs;
+
+  if (Platform->SpiWrite == NULL ||
+      Platform->DelayMs == NULL ||
+      Platform->DelayUs == NULL ||
+      Platform->Buffer == NULL ||
+      Platform->Size == 0 ||
+      Platform->SpiClockHz == 0)
+    return HD44780_FAIL;
+
+  byteNs = (8000000000ULL + Platform->SpiClockHz - 1) / Platform->SpiClockHz;
+  Platform->ByteNs = (byteNs > 0xFFFF) ? 0xFFFF : byteNs;
+  Platform->Count = 0;
+
+  Handler->Ops = &HD44780_PlatformOps;
+  Handler->Context = Platform;
+
+  return HD44780_OK;
+}
@@ -0,0 +1,117 @@
+/**
+ **********************************************************************************
+ * @file   HD44780_platform.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  This file contains the platform specific functions for HD44780 driver
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef	_HD44780_PLATFORM_H_
+#define _HD44780_PLATFORM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include "HD44780.h"
+
+
+/* Functionality Options --------------------------------------------------------*/
+/**
+ * @brief  Outputs of the 74HC595 connected to the LCD. RW must be tied to GND,
+ *         D4..D7 are connected to 4 consecutive outputs starting from D4 bit.
+ */
+#define HD44780_SR_RS_BIT           0
+#define HD44780_SR_E_BIT            1
+#define HD44780_SR_D4_BIT           4
+
+/**
+ * @brief  Delays up to this number of bytes are generated by sending the
+ *         current register image again (padding), so a whole string can be
+ *         sent in one transfer. Longer delays send the buffer and then call
+ *         DelayUs.
+ */
+#define HD44780_SR_PAD_MAX          32
+
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  Shift register transport data type. Passed to the platform functions
+ *         as context.
+ * @note   SpiWrite, DelayMs, DelayUs, SpiClockHz, Buffer and Size must be set
+ *         by user. Other fields are internal.
+ * @note   The storage register of 74HC595 must be latched (RCLK pulse) after
+ *         every byte of a transfer, e.g. by hardware NSS pulse mode of SPI.
+ * @note   SpiWrite may use DMA but must not return before the buffer can be
+ *         reused.
+ */
+typedef struct HD44780_Platform_s
+{
+  void (*SpiWrite)(void *SpiContext, const uint8_t *Data, uint16_t Len);
+  void *SpiContext;
+  void (*DelayMs)(uint16_t Delay);
+  void (*DelayUs)(uint16_t Delay);
+  uint32_t SpiClockHz;
+  uint8_t *Buffer;
+  uint16_t Size;
+
+  uint16_t ByteNs;  // time of one byte on the bus
+  uint16_t Count;   // number of bytes in the buffer
+  uint8_t Image;    // current state of the outputs
+  uint8_t Latched;  // last byte added to the buffer
+} HD44780_Platform_t;
+
+
+
+/**
+ ==================================================================================
+                             ##### Functions #####                                 
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize platform device to communicate HD44780 through a 74HC595.
+ * @note   Platform must remain valid while the handler is in use. The SPI
+ *         peripheral must be initialized by user.
+ * @param  Handler: Pointer to handler
+ * @param  Platform: Pointer to shift register transport
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Invalid parameters.
+ */
+HD44780_Result_t
+HD44780_Platform_Init(HD44780_Handler_t *Handler, HD44780_Platform_t *Platform);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //! _HD44780_PLATFORM_H_
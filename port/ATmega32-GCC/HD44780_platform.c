@@ -31,7 +31,10 @@
 /* Includes ---------------------------------------------------------------------*/
 #include "HD44780_platform.h"
 #include <avr/io.h>
+#include <avr/pgmspace.h>
 #include <util/delay.h>
+#include <util/atomic.h>
+#include <stddef.h>
 
 
 /* Private Macro ----------------------------------------------------------------*/
@@ -51,6 +54,55 @@
 #define CHECKBIT(reg,bit) ((reg & _BV(bit)) ? 1 : 0)
 #endif
 
+// Lookup tables of the default pins, computed at compile time
+#define HD44780_MIN(A, B)  (((A) < (B)) ? (A) : (B))
+
+#define HD44780_SET_BIT(N, I, BIT)  (((N) & _BV(I)) ? _BV(BIT) : 0)
+#define HD44780_DEFAULT_SET(N) \
+  (HD44780_SET_BIT(N, 0, HD44780_D4_GPIO_BIT) | \
+   HD44780_SET_BIT(N, 1, HD44780_D5_GPIO_BIT) | \
+   HD44780_SET_BIT(N, 2, HD44780_D6_GPIO_BIT) | \
+   HD44780_SET_BIT(N, 3, HD44780_D7_GPIO_BIT))
+#define HD44780_DEFAULT_MASK  HD44780_DEFAULT_SET(0x0F)
+
+#define HD44780_DEFAULT_SHIFT \
+  HD44780_MIN(HD44780_MIN(HD44780_D4_GPIO_BIT, HD44780_D5_GPIO_BIT), \
+              HD44780_MIN(HD44780_D6_GPIO_BIT, HD44780_D7_GPIO_BIT))
+#define HD44780_GET_BIT(N, I, BIT) \
+  ((((N) >> ((BIT) - HD44780_DEFAULT_SHIFT)) & 1) ? (0x10 << (I)) : 0)
+#define HD44780_DEFAULT_GET(N) \
+  (HD44780_GET_BIT(N, 0, HD44780_D4_GPIO_BIT) | \
+   HD44780_GET_BIT(N, 1, HD44780_D5_GPIO_BIT) | \
+   HD44780_GET_BIT(N, 2, HD44780_D6_GPIO_BIT) | \
+   HD44780_GET_BIT(N, 3, HD44780_D7_GPIO_BIT))
+
+#define HD44780_TABLE16(F) \
+  F(0), F(1), F(2), F(3), F(4), F(5), F(6), F(7), \
+  F(8), F(9), F(10), F(11), F(12), F(13), F(14), F(15)
+
+// Constant after optimization: all default data pins are on the same port
+#define HD44780_DEFAULT_ONE_PORT \
+  (&HD44780_D5_GPIO_PORT == &HD44780_D4_GPIO_PORT && \
+   &HD44780_D6_GPIO_PORT == &HD44780_D4_GPIO_PORT && \
+   &HD44780_D7_GPIO_PORT == &HD44780_D4_GPIO_PORT)
+
+// The data pins fit in 4 consecutive bits, so they can be read at once
+#define HD44780_DEFAULT_READ_MAPPED \
+  ((HD44780_DEFAULT_MASK >> HD44780_DEFAULT_SHIFT) <= 0x0F)
+
+
+
+/* Private Constants ------------------------------------------------------------*/
+static const uint8_t HD44780_DefaultSet[16] PROGMEM =
+{
+  HD44780_TABLE16(HD44780_DEFAULT_SET)
+};
+
+static const uint8_t HD44780_DefaultGet[16] PROGMEM =
+{
+  HD44780_TABLE16(HD44780_DEFAULT_GET)
+};
+
 
 
 /**
@@ -59,17 +111,23 @@
  ==================================================================================
  */
 
+/**
+ * Default pins: the registers are known at compile time, so single bits are
+ * changed with sbi/cbi and the data nibble uses the tables in flash.
+ */
 static void
-PlatformInitRsRwE(void)
+DefaultInitRsRwE(void *Context)
 {
+  (void)Context;
   sbi(HD44780_RS_GPIO_DDR, HD44780_RS_GPIO_BIT);
   sbi(HD44780_RW_GPIO_DDR, HD44780_RW_GPIO_BIT);
   sbi(HD44780_E_GPIO_DDR, HD44780_E_GPIO_BIT);
 }
 
 static void
-PlatformSetValRs(uint8_t Level)
+DefaultSetValRs(void *Context, uint8_t Level)
 {
+  (void)Context;
   if (Level)
     sbi(HD44780_RS_GPIO_PORT, HD44780_RS_GPIO_BIT);
   else
@@ -77,8 +135,9 @@ PlatformSetValRs(uint8_t Level)
 }
 
 static void
-PlatformSetValRw(uint8_t Level)
+DefaultSetValRw(void *Context, uint8_t Level)
 {
+  (void)Context;
   if (Level)
     sbi(HD44780_RW_GPIO_PORT, HD44780_RW_GPIO_BIT);
   else
@@ -86,8 +145,9 @@ PlatformSetValRw(uint8_t Level)
 }
 
 static void
-PlatformSetValE(uint8_t Level)
+DefaultSetValE(void *Context, uint8_t Level)
 {
+  (void)Context;
   if (Level)
     sbi(HD44780_E_GPIO_PORT, HD44780_E_GPIO_BIT);
   else
@@ -95,8 +155,23 @@ PlatformSetValE(uint8_t Level)
 }
 
 static void
-PlatformSetDirData(uint8_t Dir)
+DefaultSetDirData(void *Context, uint8_t Dir)
 {
+  (void)Context;
+
+  if (HD44780_DEFAULT_ONE_PORT)
+  {
+    // Read-modify-write of the whole register, ISRs may change other pins
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      if (Dir)
+        HD44780_D4_GPIO_DDR |= HD44780_DEFAULT_MASK;
+      else
+        HD44780_D4_GPIO_DDR &= ~HD44780_DEFAULT_MASK;
+    }
+    return;
+  }
+
   if (Dir)
   {
     sbi(HD44780_D4_GPIO_DDR, HD44780_D4_GPIO_BIT);
@@ -114,23 +189,34 @@ PlatformSetDirData(uint8_t Dir)
 }
 
 static void
-PlatformWriteData(uint8_t Data)
+DefaultWriteData(void *Context, uint8_t Data)
 {
+  uint8_t set;
+
+  (void)Context;
+
+  if (HD44780_DEFAULT_ONE_PORT)
+  {
+    set = pgm_read_byte(&HD44780_DefaultSet[Data >> 4]);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      HD44780_D4_GPIO_PORT = (HD44780_D4_GPIO_PORT & ~HD44780_DEFAULT_MASK) | set;
+    }
+    return;
+  }
+
   if (Data & 0x10)
     sbi(HD44780_D4_GPIO_PORT, HD44780_D4_GPIO_BIT);
   else
     cbi(HD44780_D4_GPIO_PORT, HD44780_D4_GPIO_BIT);
-
   if (Data & 0x20)
     sbi(HD44780_D5_GPIO_PORT, HD44780_D5_GPIO_BIT);
   else
     cbi(HD44780_D5_GPIO_PORT, HD44780_D5_GPIO_BIT);
-
   if (Data & 0x40)
     sbi(HD44780_D6_GPIO_PORT, HD44780_D6_GPIO_BIT);
   else
     cbi(HD44780_D6_GPIO_PORT, HD44780_D6_GPIO_BIT);
-
   if (Data & 0x80)
     sbi(HD44780_D7_GPIO_PORT, HD44780_D7_GPIO_BIT);
   else
@@ -138,10 +224,18 @@ PlatformWriteData(uint8_t Data)
 }
 
 static uint8_t
-PlatformReadData(void)
+DefaultReadData(void *Context)
 {
   uint8_t Data = 0;
 
+  (void)Context;
+
+  if (HD44780_DEFAULT_ONE_PORT && HD44780_DEFAULT_READ_MAPPED)
+  {
+    return pgm_read_byte(&HD44780_DefaultGet[(HD44780_D4_GPIO_PIN >>
+                                              HD44780_DEFAULT_SHIFT) & 0x0F]);
+  }
+
   if (CHECKBIT(HD44780_D4_GPIO_PIN, HD44780_D4_GPIO_BIT))
     Data |= 0x10;
   if (CHECKBIT(HD44780_D5_GPIO_PIN, HD44780_D5_GPIO_BIT))
@@ -154,20 +248,239 @@ PlatformReadData(void)
   return Data;
 }
 
+
+/**
+ * Custom pins: registers are accessed through pointers, so the compiler can
+ * not use sbi/cbi. Each read-modify-write is done with interrupts disabled,
+ * so ISRs can change other pins of the same port.
+ */
+static void
+UpdateReg(volatile uint8_t *Reg, uint8_t Mask, uint8_t Value)
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    *Reg = (*Reg & ~Mask) | Value;
+  }
+}
+
+static void
+SetPin(const HD44780_PlatformPin_t *Pin, uint8_t Level)
+{
+  UpdateReg(Pin->Port, _BV(Pin->Bit), Level ? _BV(Pin->Bit) : 0);
+}
+
+static void
+PlatformInitRsRwE(void *Context)
+{
+  const HD44780_Platform_t *Pins = (const HD44780_Platform_t *)Context;
+
+  UpdateReg(Pins->Rs.Ddr, _BV(Pins->Rs.Bit), _BV(Pins->Rs.Bit));
+  UpdateReg(Pins->Rw.Ddr, _BV(Pins->Rw.Bit), _BV(Pins->Rw.Bit));
+  UpdateReg(Pins->E.Ddr, _BV(Pins->E.Bit), _BV(Pins->E.Bit));
+}
+
+static void
+PlatformSetValRs(void *Context, uint8_t Level)
+{
+  SetPin(&((const HD44780_Platform_t *)Context)->Rs, Level);
+}
+
+static void
+PlatformSetValRw(void *Context, uint8_t Level)
+{
+  SetPin(&((const HD44780_Platform_t *)Context)->Rw, Level);
+}
+
+static void
+PlatformSetValE(void *Context, uint8_t Level)
+{
+  SetPin(&((const HD44780_Platform_t *)Context)->E, Level);
+}
+
+static void
+PlatformSetDirData(void *Context, uint8_t Dir)
+{
+  const HD44780_Platform_t *Pins = (const HD44780_Platform_t *)Context;
+  const HD44780_PlatformPort_t *port;
+  uint8_t i;
+
+  if (Pins->PortCount == 0)
+  {
+    for (i = 0; i < 4; i++)
+    {
+      UpdateReg(Pins->D[i].Ddr, _BV(Pins->D[i].Bit),
+                Dir ? _BV(Pins->D[i].Bit) : 0);
+    }
+    return;
+  }
+
+  for (i = 0; i < Pins->PortCount; i++)
+  {
+    port = &Pins->Ports[i];
+    UpdateReg(port->Ddr, port->Mask, Dir ? port->Mask : 0);
+  }
+}
+
+static void
+PlatformWriteData(void *Context, uint8_t Data)
+{
+  const HD44780_Platform_t *Pins = (const HD44780_Platform_t *)Context;
+  const HD44780_PlatformPort_t *port;
+  uint8_t i;
+
+  if (Pins->PortCount == 0)
+  {
+    for (i = 0; i < 4; i++)
+      SetPin(&Pins->D[i], Data & (0x10 << i));
+    return;
+  }
+
+  Data >>= 4;
+  for (i = 0; i < Pins->PortCount; i++)
+  {
+    port = &Pins->Ports[i];
+    UpdateReg(port->Port, port->Mask, port->Set[Data]);
+  }
+}
+
+static uint8_t
+PlatformReadData(void *Context)
+{
+  const HD44780_Platform_t *Pins = (const HD44780_Platform_t *)Context;
+  const HD44780_PlatformPort_t *port;
+  uint8_t Data = 0;
+  uint8_t i;
+
+  if (Pins->PortCount == 0 || !Pins->ReadMapped)
+  {
+    for (i = 0; i < 4; i++)
+    {
+      if (CHECKBIT(*Pins->D[i].Pin, Pins->D[i].Bit))
+        Data |= (0x10 << i);
+    }
+    return Data;
+  }
+
+  for (i = 0; i < Pins->PortCount; i++)
+  {
+    port = &Pins->Ports[i];
+    Data |= port->Get[(*port->Pin >> port->Shift) & 0x0F];
+  }
+
+  return Data;
+}
+
 static void
-PlatformDelayMs(uint16_t Delay)
+PlatformDelayMs(void *Context, uint16_t Delay)
 {
+  (void)Context;
   for (; Delay > 0; Delay--)
     _delay_ms(1);
 }
 
 static void
-PlatformDelayUs(uint16_t Delay)
+PlatformDelayUs(void *Context, uint16_t Delay)
 {
+  (void)Context;
   for (; Delay > 0; Delay--)
     _delay_us(1);
 }
 
+static void
+PlatformMapPins(HD44780_Platform_t *Pins)
+{
+  HD44780_PlatformPort_t *port;
+  uint8_t i, j, n;
+
+  // Group data pins by port
+  Pins->PortCount = 0;
+  for (i = 0; i < 4; i++)
+  {
+    for (j = 0; j < Pins->PortCount; j++)
+    {
+      if (Pins->Ports[j].Port == Pins->D[i].Port)
+        break;
+    }
+
+    if (j == Pins->PortCount)
+    {
+      if (j == HD44780_DATA_PORTS)
+      {
+        // Too many ports, access pins one by one
+        Pins->PortCount = 0;
+        return;
+      }
+
+      Pins->Ports[j].Port = Pins->D[i].Port;
+      Pins->Ports[j].Ddr = Pins->D[i].Ddr;
+      Pins->Ports[j].Pin = Pins->D[i].Pin;
+      Pins->Ports[j].Mask = 0;
+      Pins->PortCount++;
+    }
+
+    Pins->Ports[j].Mask |= _BV(Pins->D[i].Bit);
+  }
+
+  Pins->ReadMapped = 1;
+  for (j = 0; j < Pins->PortCount; j++)
+  {
+    port = &Pins->Ports[j];
+
+    port->Shift = 0;
+    while (!(port->Mask & _BV(port->Shift)))
+      port->Shift++;
+    if ((port->Mask >> port->Shift) > 0x0F)
+      Pins->ReadMapped = 0;
+
+    for (n = 0; n < 16; n++)
+    {
+      port->Set[n] = 0;
+      port->Get[n] = 0;
+      for (i = 0; i < 4; i++)
+      {
+        if (Pins->D[i].Port != port->Port)
+          continue;
+        if (n & _BV(i))
+          port->Set[n] |= _BV(Pins->D[i].Bit);
+        if ((Pins->D[i].Bit - port->Shift) < 4 &&
+            (n & _BV(Pins->D[i].Bit - port->Shift)))
+          port->Get[n] |= (0x10 << i);
+      }
+    }
+  }
+}
+
+
+static const HD44780_OPS_SPACE HD44780_Ops_t HD44780_DefaultOps =
+{
+  DefaultInitRsRwE,
+  DefaultSetValRs,
+  DefaultSetValRw,
+  DefaultSetValE,
+  DefaultSetDirData,
+  DefaultWriteData,
+  DefaultReadData,
+  PlatformDelayMs,
+  PlatformDelayUs,
+  NULL, // pin changes are not buffered
+  NULL  // timers are left to the application
+};
+
+static const HD44780_OPS_SPACE HD44780_Ops_t HD44780_PlatformOps =
+{
+  PlatformInitRsRwE,
+  PlatformSetValRs,
+  PlatformSetValRw,
+  PlatformSetValE,
+  PlatformSetDirData,
+  PlatformWriteData,
+  PlatformReadData,
+  PlatformDelayMs,
+  PlatformDelayUs,
+  NULL, // pin changes are not buffered
+  NULL  // timers are left to the application
+};
+
 
 
 /**
@@ -178,19 +491,34 @@ PlatformDelayUs(uint16_t Delay)
 
 /**
  * @brief  Initialize platform device to communicate HD44780.
+ * @note   The pins defined in HD44780_platform.h are used. Their lookup
+ *         tables are computed at compile time and kept in flash, so no RAM
+ *         is used.
  * @param  Handler: Pointer to handler
  * @retval None
  */
 void
 HD44780_Platform_Init(HD44780_Handler_t *Handler)
 {
-  Handler->PlatformInitRsRwE = PlatformInitRsRwE;
-  Handler->PlatformSetValRs = PlatformSetValRs;
-  Handler->PlatformSetValRw = PlatformSetValRw;
-  Handler->PlatformSetValE = PlatformSetValE;
-  Handler->PlatformSetDirData = PlatformSetDirData;
-  Handler->PlatformWriteData = PlatformWriteData;
-  Handler->PlatformReadData = PlatformReadData;
-  Handler->PlatformDelayMs = PlatformDelayMs;
-  Handler->PlatformDelayUs = PlatformDelayUs;
+  Handler->Ops = &HD44780_DefaultOps;
+  Handler->Context = NULL;
+}
+
+/**
+ * @brief  Initialize platform device to communicate HD44780 with a custom pin
+ *         set. Useful when several displays are connected.
+ * @note   Pins must remain valid while the handler is in use. Lookup tables
+ *         of the data pins are computed and stored in it.
+ * @param  Handler: Pointer to handler
+ * @param  Pins: Pointer to pin set of the display
+ * @retval None
+ */
+void
+HD44780_Platform_InitPins(HD44780_Handler_t *Handler,
+                          HD44780_Platform_t *Pins)
+{
+  PlatformMapPins(Pins);
+
+  Handler->Ops = &HD44780_PlatformOps;
+  Handler->Context = Pins;
 }
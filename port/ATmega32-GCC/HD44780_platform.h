@@ -68,6 +68,61 @@ extern "C" {
 #define HD44780_D7_GPIO_DDR         DDRA
 #define HD44780_D7_GPIO_BIT         7
 
+/**
+ * @brief  Maximum number of ports the data pins of a custom pin set
+ *         (HD44780_Platform_InitPins()) are spread over. Each port costs 36
+ *         bytes of RAM per display for lookup tables. If the data pins use
+ *         more ports, they are accessed one by one (slower). The default pins
+ *         above use tables in flash instead.
+ */
+#define HD44780_DATA_PORTS          1
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  Pin data type
+ * @note   Pin register is only used for D4..D7.
+ */
+typedef struct HD44780_PlatformPin_s
+{
+  volatile uint8_t *Port;
+  volatile uint8_t *Ddr;
+  volatile uint8_t *Pin;
+  uint8_t Bit;
+} HD44780_PlatformPin_t;
+
+/**
+ * @brief  Data pins of one port with lookup tables to access them at once
+ */
+typedef struct HD44780_PlatformPort_s
+{
+  volatile uint8_t *Port;
+  volatile uint8_t *Ddr;
+  volatile uint8_t *Pin;
+  uint8_t Mask;     // data pins of this port
+  uint8_t Shift;    // lowest data pin of this port
+  uint8_t Set[16];  // port bits for each value of D7..D4
+  uint8_t Get[16];  // D7..D4 (as high nibble) for each 4 input bits from Shift
+} HD44780_PlatformPort_t;
+
+/**
+ * @brief  Pin set of one display. Passed to the platform functions as context.
+ * @note   D[0] is D4 and D[3] is D7.
+ * @note   Ports, PortCount and ReadMapped are computed by
+ *         HD44780_Platform_InitPins().
+ */
+typedef struct HD44780_Platform_s
+{
+  HD44780_PlatformPin_t Rs;
+  HD44780_PlatformPin_t Rw;
+  HD44780_PlatformPin_t E;
+  HD44780_PlatformPin_t D[4];
+
+  HD44780_PlatformPort_t Ports[HD44780_DATA_PORTS];
+  uint8_t PortCount;  // 0: data pins are accessed one by one
+  uint8_t ReadMapped; // data pins of each port fit in 4 consecutive bits
+} HD44780_Platform_t;
+
 
 
 /**
@@ -78,12 +133,27 @@ extern "C" {
 
 /**
  * @brief  Initialize platform device to communicate HD44780.
+ * @note   The pins defined in this file are used. Their lookup tables are
+ *         computed at compile time and kept in flash, so no RAM is used.
  * @param  Handler: Pointer to handler
  * @retval None
  */
 void
 HD44780_Platform_Init(HD44780_Handler_t *Handler);
 
+/**
+ * @brief  Initialize platform device to communicate HD44780 with a custom pin
+ *         set. Useful when several displays are connected.
+ * @note   Pins must remain valid while the handler is in use. Lookup tables
+ *         of the data pins are computed and stored in it.
+ * @param  Handler: Pointer to handler
+ * @param  Pins: Pointer to pin set of the display
+ * @retval None
+ */
+void
+HD44780_Platform_InitPins(HD44780_Handler_t *Handler,
+                          HD44780_Platform_t *Pins);
+
 
 #ifdef __cplusplus
 }
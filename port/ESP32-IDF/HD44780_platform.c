@@ -32,8 +32,36 @@
 #include "HD44780_platform.h"
 #include "sdkconfig.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 #include "driver/gpio.h"
 #include "freertos/FreeRTOS.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#include <stddef.h>
+
+
+/* Private Macro ----------------------------------------------------------------*/
+#ifdef GPIO_OUT1_W1TS_REG
+#define HD44780_W1TS_REG(Bank)  ((Bank) ? GPIO_OUT1_W1TS_REG : GPIO_OUT_W1TS_REG)
+#define HD44780_W1TC_REG(Bank)  ((Bank) ? GPIO_OUT1_W1TC_REG : GPIO_OUT_W1TC_REG)
+#define HD44780_IN_REG(Bank)    ((Bank) ? GPIO_IN1_REG : GPIO_IN_REG)
+#else
+#define HD44780_W1TS_REG(Bank)  GPIO_OUT_W1TS_REG
+#define HD44780_W1TC_REG(Bank)  GPIO_OUT_W1TC_REG
+#define HD44780_IN_REG(Bank)    GPIO_IN_REG
+#endif
+
+
+
+/* Private Variables ------------------------------------------------------------*/
+static HD44780_Platform_t HD44780_DefaultPins =
+{
+  HD44780_RS_GPIO,
+  HD44780_RW_GPIO,
+  HD44780_E_GPIO,
+  {HD44780_D4_GPIO, HD44780_D5_GPIO, HD44780_D6_GPIO, HD44780_D7_GPIO},
+  {{0}}, 0, 0, 0 // set by HD44780_Platform_InitPins()
+};
 
 
 
@@ -60,88 +88,195 @@ SetGPIO_IN(gpio_num_t GPIO_Pad)
 
 
 static void
-PlatformInitRsRwE(void)
+PlatformInitRsRwE(void *Context)
 {
-  SetGPIO_OUT(HD44780_RS_GPIO);
-  SetGPIO_OUT(HD44780_RW_GPIO);
-  SetGPIO_OUT(HD44780_E_GPIO);
+  const HD44780_Platform_t *Pins = (const HD44780_Platform_t *)Context;
+
+  SetGPIO_OUT(Pins->Rs);
+  SetGPIO_OUT(Pins->Rw);
+  SetGPIO_OUT(Pins->E);
 }
 
 static void
-PlatformSetValRs(uint8_t Level)
+PlatformSetValRs(void *Context, uint8_t Level)
 {
-  gpio_set_level(HD44780_RS_GPIO, Level);
+  gpio_set_level(((const HD44780_Platform_t *)Context)->Rs, Level);
 }
 
 static void
-PlatformSetValRw(uint8_t Level)
+PlatformSetValRw(void *Context, uint8_t Level)
 {
-  gpio_set_level(HD44780_RW_GPIO, Level);
+  gpio_set_level(((const HD44780_Platform_t *)Context)->Rw, Level);
 }
 
 static void
-PlatformSetValE(uint8_t Level)
+PlatformSetValE(void *Context, uint8_t Level)
 {
-  gpio_set_level(HD44780_E_GPIO, Level);
+  gpio_set_level(((const HD44780_Platform_t *)Context)->E, Level);
 }
 
 static void
-PlatformSetDirData(uint8_t Dir)
+PlatformSetDirData(void *Context, uint8_t Dir)
 {
-  if (Dir)
-  {
-    SetGPIO_OUT(HD44780_D4_GPIO);
-    SetGPIO_OUT(HD44780_D5_GPIO);
-    SetGPIO_OUT(HD44780_D6_GPIO);
-    SetGPIO_OUT(HD44780_D7_GPIO);
-  }
-  else
+  HD44780_Platform_t *Pins = (HD44780_Platform_t *)Context;
+  uint8_t i;
+
+  // Reconfiguring pins is slow, skip it if direction is not changed
+  Dir = Dir ? 1 : 0;
+  if (Pins->Dir == Dir)
+    return;
+  Pins->Dir = Dir;
+
+  for (i = 0; i < 4; i++)
   {
-    SetGPIO_IN(HD44780_D4_GPIO);
-    SetGPIO_IN(HD44780_D5_GPIO);
-    SetGPIO_IN(HD44780_D6_GPIO);
-    SetGPIO_IN(HD44780_D7_GPIO);
+    if (Dir)
+      SetGPIO_OUT(Pins->D[i]);
+    else
+      SetGPIO_IN(Pins->D[i]);
   }
 }
 
 static void
-PlatformWriteData(uint8_t Data)
+PlatformWriteData(void *Context, uint8_t Data)
 {
-  gpio_set_level(HD44780_D4_GPIO, (Data & 0x10));
-  gpio_set_level(HD44780_D5_GPIO, (Data & 0x20));
-  gpio_set_level(HD44780_D6_GPIO, (Data & 0x40));
-  gpio_set_level(HD44780_D7_GPIO, (Data & 0x80));
+  const HD44780_Platform_t *Pins = (const HD44780_Platform_t *)Context;
+  const HD44780_PlatformBank_t *bank;
+  uint8_t i;
+
+  Data >>= 4;
+  for (i = 0; i < Pins->BankCount; i++)
+  {
+    bank = &Pins->Banks[i];
+    REG_WRITE(HD44780_W1TS_REG(bank->Bank), bank->Set[Data]);
+    REG_WRITE(HD44780_W1TC_REG(bank->Bank), bank->Clear[Data]);
+  }
 }
 
 static uint8_t
-PlatformReadData(void)
+PlatformReadData(void *Context)
 {
+  const HD44780_Platform_t *Pins = (const HD44780_Platform_t *)Context;
+  const HD44780_PlatformBank_t *bank;
   uint8_t Data = 0;
+  uint8_t i;
 
-  if (gpio_get_level(HD44780_D4_GPIO))
-    Data |= 0x10;
-  if (gpio_get_level(HD44780_D5_GPIO))
-    Data |= 0x20;
-  if (gpio_get_level(HD44780_D6_GPIO))
-    Data |= 0x40;
-  if (gpio_get_level(HD44780_D7_GPIO))
-    Data |= 0x80;
+  if (!Pins->ReadMapped)
+  {
+    for (i = 0; i < 4; i++)
+    {
+      if (gpio_get_level(Pins->D[i]))
+        Data |= (0x10 << i);
+    }
+    return Data;
+  }
+
+  for (i = 0; i < Pins->BankCount; i++)
+  {
+    bank = &Pins->Banks[i];
+    Data |= bank->Get[(REG_READ(HD44780_IN_REG(bank->Bank)) >> bank->Shift) & 0x0F];
+  }
 
   return Data;
 }
 
 static void
-PlatformDelayMs(uint16_t Delay)
+PlatformDelayMs(void *Context, uint16_t Delay)
 {
+  (void)Context;
   vTaskDelay(Delay / portTICK_PERIOD_MS);
 }
 
 static void
-PlatformDelayUs(uint16_t Delay)
+PlatformDelayUs(void *Context, uint16_t Delay)
 {
+  (void)Context;
   ets_delay_us(Delay);
 }
 
+static uint32_t
+PlatformGetTimeUs(void *Context)
+{
+  (void)Context;
+  return (uint32_t)esp_timer_get_time();
+}
+
+
+static void
+PlatformMapPins(HD44780_Platform_t *Pins)
+{
+  HD44780_PlatformBank_t *bank;
+  uint8_t i, j, n, bit;
+
+  // Group data pins by bank
+  Pins->BankCount = 0;
+  for (i = 0; i < 4; i++)
+  {
+    for (j = 0; j < Pins->BankCount; j++)
+    {
+      if (Pins->Banks[j].Bank == Pins->D[i] / 32)
+        break;
+    }
+
+    if (j == Pins->BankCount)
+    {
+      Pins->Banks[j].Bank = Pins->D[i] / 32;
+      Pins->Banks[j].Mask = 0;
+      Pins->BankCount++;
+    }
+
+    Pins->Banks[j].Mask |= 1UL << (Pins->D[i] % 32);
+  }
+
+  Pins->ReadMapped = 1;
+  for (j = 0; j < Pins->BankCount; j++)
+  {
+    bank = &Pins->Banks[j];
+
+    bank->Shift = 0;
+    while (!(bank->Mask & (1UL << bank->Shift)))
+      bank->Shift++;
+    if ((bank->Mask >> bank->Shift) > 0x0F)
+      Pins->ReadMapped = 0;
+
+    for (n = 0; n < 16; n++)
+    {
+      bank->Set[n] = 0;
+      bank->Clear[n] = 0;
+      bank->Get[n] = 0;
+      for (i = 0; i < 4; i++)
+      {
+        if (Pins->D[i] / 32 != bank->Bank)
+          continue;
+
+        bit = Pins->D[i] % 32;
+        if (n & (1 << i))
+          bank->Set[n] |= 1UL << bit;
+        else
+          bank->Clear[n] |= 1UL << bit;
+
+        if ((bit - bank->Shift) < 4 && (n & (1 << (bit - bank->Shift))))
+          bank->Get[n] |= (0x10 << i);
+      }
+    }
+  }
+}
+
+
+static const HD44780_OPS_SPACE HD44780_Ops_t HD44780_PlatformOps =
+{
+  PlatformInitRsRwE,
+  PlatformSetValRs,
+  PlatformSetValRw,
+  PlatformSetValE,
+  PlatformSetDirData,
+  PlatformWriteData,
+  PlatformReadData,
+  PlatformDelayMs,
+  PlatformDelayUs,
+  NULL, // pin changes are not buffered
+  PlatformGetTimeUs
+};
+
 
 
 /**
@@ -152,19 +287,32 @@ PlatformDelayUs(uint16_t Delay)
 
 /**
  * @brief  Initialize platform device to communicate HD44780.
+ * @note   The pins defined in HD44780_platform.h are used.
  * @param  Handler: Pointer to handler
  * @retval None
  */
 void
 HD44780_Platform_Init(HD44780_Handler_t *Handler)
 {
-  Handler->PlatformInitRsRwE = PlatformInitRsRwE;
-  Handler->PlatformSetValRs = PlatformSetValRs;
-  Handler->PlatformSetValRw = PlatformSetValRw;
-  Handler->PlatformSetValE = PlatformSetValE;
-  Handler->PlatformSetDirData = PlatformSetDirData;
-  Handler->PlatformWriteData = PlatformWriteData;
-  Handler->PlatformReadData = PlatformReadData;
-  Handler->PlatformDelayMs = PlatformDelayMs;
-  Handler->PlatformDelayUs = PlatformDelayUs;
+  HD44780_Platform_InitPins(Handler, &HD44780_DefaultPins);
+}
+
+/**
+ * @brief  Initialize platform device to communicate HD44780 with a custom pin
+ *         set. Useful when several displays are connected.
+ * @note   Pins must remain valid while the handler is in use. Lookup tables
+ *         of the data pins are computed and stored in it.
+ * @param  Handler: Pointer to handler
+ * @param  Pins: Pointer to pin set of the display
+ * @retval None
+ */
+void
+HD44780_Platform_InitPins(HD44780_Handler_t *Handler,
+                          HD44780_Platform_t *Pins)
+{
+  PlatformMapPins(Pins);
+  Pins->Dir = 0xFF; // unknown
+
+  Handler->Ops = &HD44780_PlatformOps;
+  Handler->Context = Pins;
 }
@@ -39,6 +39,7 @@ extern "C" {
 
 /* Includes ---------------------------------------------------------------------*/
 #include "HD44780.h"
+#include "driver/gpio.h"
 
 
 /* Functionality Options --------------------------------------------------------*/
@@ -52,6 +53,42 @@ extern "C" {
 
 
 
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  Data pins of one GPIO bank (GPIO0..31 or GPIO32..) with lookup
+ *         tables to access them at once
+ */
+typedef struct HD44780_PlatformBank_s
+{
+  uint8_t Bank;
+  uint8_t Shift;      // lowest data pin of this bank
+  uint32_t Mask;      // data pins of this bank
+  uint32_t Set[16];   // W1TS value for each value of D7..D4
+  uint32_t Clear[16]; // W1TC value for each value of D7..D4
+  uint8_t Get[16];    // D7..D4 (as high nibble) for each 4 input bits from Shift
+} HD44780_PlatformBank_t;
+
+/**
+ * @brief  Pin set of one display. Passed to the platform functions as context.
+ * @note   D[0] is D4 and D[3] is D7.
+ * @note   Banks, BankCount, ReadMapped and Dir are set by
+ *         HD44780_Platform_InitPins().
+ */
+typedef struct HD44780_Platform_s
+{
+  gpio_num_t Rs;
+  gpio_num_t Rw;
+  gpio_num_t E;
+  gpio_num_t D[4];
+
+  HD44780_PlatformBank_t Banks[2];
+  uint8_t BankCount;
+  uint8_t ReadMapped; // data pins of each bank fit in 4 consecutive bits
+  uint8_t Dir;        // current direction of data pins
+} HD44780_Platform_t;
+
+
+
 /**
  ==================================================================================
                              ##### Functions #####                                 
@@ -60,12 +97,26 @@ extern "C" {
 
 /**
  * @brief  Initialize platform device to communicate HD44780.
+ * @note   The pins defined in this file are used.
  * @param  Handler: Pointer to handler
  * @retval None
  */
 void
 HD44780_Platform_Init(HD44780_Handler_t *Handler);
 
+/**
+ * @brief  Initialize platform device to communicate HD44780 with a custom pin
+ *         set. Useful when several displays are connected.
+ * @note   Pins must remain valid while the handler is in use. Lookup tables
+ *         of the data pins are computed and stored in it.
+ * @param  Handler: Pointer to handler
+ * @param  Pins: Pointer to pin set of the display
+ * @retval None
+ */
+void
+HD44780_Platform_InitPins(HD44780_Handler_t *Handler,
+                          HD44780_Platform_t *Pins);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,381 @@
+/**
+ **********************************************************************************
+ * @file   HD44780_platform.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  This file contains the platform specific functions for HD44780 driver
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "HD44780_platform.h"
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+
+/* Private Macro ----------------------------------------------------------------*/
+// Index of each line in the request: D4..D7 first, so the nibble is bits 0..3
+#define HD44780_LINUX_DATA_MASK  0x0FULL
+#define HD44780_LINUX_RS_BIT     4
+#define HD44780_LINUX_E_BIT      5
+#define HD44780_LINUX_RW_BIT     6
+
+#define HD44780_LINUX_ALL(P)     ((1ULL << (P)->Lines) - 1)
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static uint64_t
+Linux_NowNs(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static int
+Linux_Ioctl(HD44780_Platform_t *Platform, int Fd, unsigned long Request,
+            void *Arg)
+{
+  Platform->Syscalls++;
+
+  if (Platform->Ioctl)
+    return Platform->Ioctl(Fd, Request, Arg);
+
+  return ioctl(Fd, Request, Arg);
+}
+
+// Wait until the delays requested so far have passed
+static void
+Linux_Wait(HD44780_Platform_t *Platform)
+{
+  struct timespec until;
+  uint64_t now = Linux_NowNs();
+  uint64_t sleep;
+
+  if (now >= Platform->ReadyNs)
+    return;
+
+  if (Platform->ReadyNs - now > HD44780_LINUX_SPIN_US * 1000ULL)
+  {
+    sleep = Platform->ReadyNs - HD44780_LINUX_SPIN_US * 1000ULL;
+    until.tv_sec = sleep / 1000000000ULL;
+    until.tv_nsec = sleep % 1000000000ULL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) != 0)
+    {
+    }
+  }
+
+  while (Linux_NowNs() < Platform->ReadyNs)
+  {
+  }
+}
+
+// Delays start when they are requested but are only waited for before the
+// next change of the lines, so the time of the system calls is not added
+static void
+Linux_Delay(HD44780_Platform_t *Platform, uint64_t Ns)
+{
+  uint64_t ready = Linux_NowNs() + Ns;
+
+  if (ready > Platform->ReadyNs)
+    Platform->ReadyNs = ready;
+}
+
+static void
+Linux_Emit(HD44780_Platform_t *Platform)
+{
+  struct gpio_v2_line_values values;
+
+  values.bits = Platform->Image;
+  values.mask = HD44780_LINUX_ALL(Platform);
+  if (Platform->Input)
+    values.mask &= ~HD44780_LINUX_DATA_MASK;
+
+  Linux_Wait(Platform);
+  Linux_Ioctl(Platform, Platform->LineFd, GPIO_V2_LINE_SET_VALUES_IOCTL, &values);
+  Platform->Sent = Platform->Image;
+}
+
+static void
+Linux_Config(HD44780_Platform_t *Platform, struct gpio_v2_line_config *Config)
+{
+  memset(Config, 0, sizeof(*Config));
+  Config->flags = GPIO_V2_LINE_FLAG_OUTPUT;
+
+  Config->attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+  Config->attrs[0].attr.values = Platform->Image;
+  Config->attrs[0].mask = HD44780_LINUX_ALL(Platform);
+  Config->num_attrs = 1;
+
+  if (Platform->Input)
+  {
+    Config->attrs[1].attr.id = GPIO_V2_LINE_ATTR_ID_FLAGS;
+    Config->attrs[1].attr.flags = GPIO_V2_LINE_FLAG_INPUT;
+    Config->attrs[1].mask = HD44780_LINUX_DATA_MASK;
+    Config->num_attrs = 2;
+  }
+}
+
+static void
+Linux_SetBit(HD44780_Platform_t *Platform, uint8_t Bit, uint8_t Level)
+{
+  if (Level)
+    Platform->Image |= (1ULL << Bit);
+  else
+    Platform->Image &= ~(1ULL << Bit);
+}
+
+
+static void
+PlatformInitRsRwE(void *Context)
+{
+  HD44780_Platform_t *Platform = (HD44780_Platform_t *)Context;
+
+  Platform->Image = 0;
+  Linux_Emit(Platform);
+}
+
+static void
+PlatformSetValRs(void *Context, uint8_t Level)
+{
+  Linux_SetBit((HD44780_Platform_t *)Context, HD44780_LINUX_RS_BIT, Level);
+}
+
+static void
+PlatformSetValRw(void *Context, uint8_t Level)
+{
+  HD44780_Platform_t *Platform = (HD44780_Platform_t *)Context;
+
+  // RW is tied to GND if it is not requested
+  if (Platform->Lines > HD44780_LINUX_RW_BIT)
+    Linux_SetBit(Platform, HD44780_LINUX_RW_BIT, Level);
+}
+
+static void
+PlatformSetValE(void *Context, uint8_t Level)
+{
+  HD44780_Platform_t *Platform = (HD44780_Platform_t *)Context;
+  const uint64_t control = (1ULL << HD44780_LINUX_RS_BIT) |
+                           (1ULL << HD44780_LINUX_RW_BIT);
+
+  // RS and RW must be stable before the rising edge of E. Data is latched at
+  // the falling edge, so it can change together with the rising edge.
+  if (Level && ((Platform->Image ^ Platform->Sent) & control))
+    Linux_Emit(Platform);
+
+  Linux_SetBit(Platform, HD44780_LINUX_E_BIT, Level);
+  Linux_Emit(Platform);
+}
+
+static void
+PlatformSetDirData(void *Context, uint8_t Dir)
+{
+  HD44780_Platform_t *Platform = (HD44780_Platform_t *)Context;
+  struct gpio_v2_line_config config;
+
+  if (Platform->Input == !Dir)
+    return;
+
+  // Output values (RS and RW too) are written with the new direction
+  Platform->Input = !Dir;
+  Linux_Config(Platform, &config);
+  Linux_Wait(Platform);
+  Linux_Ioctl(Platform, Platform->LineFd, GPIO_V2_LINE_SET_CONFIG_IOCTL, &config);
+  Platform->Sent = Platform->Image;
+}
+
+static void
+PlatformWriteData(void *Context, uint8_t Data)
+{
+  HD44780_Platform_t *Platform = (HD44780_Platform_t *)Context;
+
+  Platform->Image = (Platform->Image & ~HD44780_LINUX_DATA_MASK) | (Data >> 4);
+}
+
+static uint8_t
+PlatformReadData(void *Context)
+{
+  HD44780_Platform_t *Platform = (HD44780_Platform_t *)Context;
+  struct gpio_v2_line_values values;
+
+  values.bits = 0;
+  values.mask = HD44780_LINUX_DATA_MASK;
+
+  Linux_Wait(Platform);
+  Linux_Ioctl(Platform, Platform->LineFd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values);
+
+  return (values.bits & HD44780_LINUX_DATA_MASK) << 4;
+}
+
+static void
+PlatformDelayMs(void *Context, uint16_t Delay)
+{
+  Linux_Delay((HD44780_Platform_t *)Context, Delay * 1000000ULL);
+}
+
+static void
+PlatformDelayUs(void *Context, uint16_t Delay)
+{
+  Linux_Delay((HD44780_Platform_t *)Context, Delay * 1000ULL);
+}
+
+static uint32_t
+PlatformGetTimeUs(void *Context)
+{
+  (void)Context;
+  return (uint32_t)(Linux_NowNs() / 1000);
+}
+
+
+static const HD44780_OPS_SPACE HD44780_Ops_t HD44780_PlatformOps =
+{
+  PlatformInitRsRwE,
+  PlatformSetValRs,
+  PlatformSetValRw,
+  PlatformSetValE,
+  PlatformSetDirData,
+  PlatformWriteData,
+  PlatformReadData,
+  PlatformDelayMs,
+  PlatformDelayUs,
+  NULL,
+  PlatformGetTimeUs
+};
+
+static const HD44780_OPS_SPACE HD44780_Ops_t HD44780_PlatformOpsWriteOnly =
+{
+  PlatformInitRsRwE,
+  PlatformSetValRs,
+  PlatformSetValRw,
+  PlatformSetValE,
+  PlatformSetDirData,
+  PlatformWriteData,
+  NULL, // RW is tied to GND
+  PlatformDelayMs,
+  PlatformDelayUs,
+  NULL,
+  PlatformGetTimeUs
+};
+
+
+
+/**
+ ==================================================================================
+                         ##### Public Functions #####                              
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize platform device to communicate HD44780 through the Linux
+ *         GPIO character device.
+ * @note   Platform must remain valid while the handler is in use. The lines
+ *         are requested from the kernel and held until
+ *         HD44780_Platform_DeInit().
+ * @param  Handler: Pointer to handler
+ * @param  Platform: Pointer to GPIO transport
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: The chip could not be opened or the lines could not
+ *                         be requested (e.g. they are in use).
+ */
+HD44780_Result_t
+HD44780_Platform_Init(HD44780_Handler_t *Handler, HD44780_Platform_t *Platform)
+{
+  struct gpio_v2_line_request request;
+  uint8_t i;
+
+  Platform->ChipFd = -1;
+  Platform->LineFd = -1;
+  Platform->Image = 0;
+  Platform->Sent = 0;
+  Platform->ReadyNs = 0;
+  Platform->Syscalls = 0;
+  Platform->Input = 0;
+  Platform->Lines = (Platform->Rw == HD44780_LINUX_NO_LINE) ?
+                    HD44780_LINUX_RW_BIT : HD44780_LINUX_RW_BIT + 1;
+
+  if (Platform->Chip != NULL)
+  {
+    Platform->ChipFd = open(Platform->Chip, O_RDWR | O_CLOEXEC);
+    if (Platform->ChipFd < 0)
+      return HD44780_FAIL;
+  }
+  else if (Platform->Ioctl == NULL)
+  {
+    return HD44780_FAIL;
+  }
+
+  memset(&request, 0, sizeof(request));
+  for (i = 0; i < 4; i++)
+    request.offsets[i] = Platform->D[i];
+  request.offsets[HD44780_LINUX_RS_BIT] = Platform->Rs;
+  request.offsets[HD44780_LINUX_E_BIT] = Platform->E;
+  request.offsets[HD44780_LINUX_RW_BIT] = Platform->Rw;
+  request.num_lines = Platform->Lines;
+  strncpy(request.consumer, "HD44780", sizeof(request.consumer) - 1);
+  Linux_Config(Platform, &request.config);
+
+  if (Linux_Ioctl(Platform, Platform->ChipFd,
+                  GPIO_V2_GET_LINE_IOCTL, &request) < 0)
+  {
+    HD44780_Platform_DeInit(Platform);
+    return HD44780_FAIL;
+  }
+  Platform->LineFd = request.fd;
+
+  Handler->Ops = (Platform->Rw == HD44780_LINUX_NO_LINE) ?
+                 &HD44780_PlatformOpsWriteOnly : &HD44780_PlatformOps;
+  Handler->Context = Platform;
+
+  return HD44780_OK;
+}
+
+/**
+ * @brief  Release the lines and close the chip
+ * @param  Platform: Pointer to GPIO transport
+ * @retval None
+ */
+void
+HD44780_Platform_DeInit(HD44780_Platform_t *Platform)
+{
+  if (Platform->LineFd >= 0 && Platform->Ioctl == NULL)
+    close(Platform->LineFd);
+
+  if (Platform->ChipFd >= 0)
+    close(Platform->ChipFd);
+
+  Platform->LineFd = -1;
+  Platform->ChipFd = -1;
+}
@@ -0,0 +1,132 @@
+/**
+ **********************************************************************************
+ * @file   HD44780_platform.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  This file contains the platform specific functions for HD44780 driver
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef	_HD44780_PLATFORM_H_
+#define _HD44780_PLATFORM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include "HD44780.h"
+
+
+/* Functionality Options --------------------------------------------------------*/
+/**
+ * @brief  Delays shorter than this (in microseconds) are busy-waited. Longer
+ *         delays sleep with clock_nanosleep() and busy-wait only for the last
+ *         part, so the timer slack of the kernel does not lengthen them.
+ */
+#define HD44780_LINUX_SPIN_US       100
+
+/**
+ * @brief  Set Rw to this value if RW of the display is tied to GND
+ */
+#define HD44780_LINUX_NO_LINE       0xFFFFFFFFUL
+
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  GPIO character device transport data type. Passed to the platform
+ *         functions as context.
+ * @note   Chip, Rs, Rw, E and D must be set by user. D[0] is D4 and D[3] is D7.
+ *         Line numbers are offsets on the chip (see gpioinfo). Other fields
+ *         are internal.
+ * @note   All lines are requested together and each change of E updates RS,
+ *         RW, E and the data nibble with one ioctl, so writing a byte takes 4
+ *         system calls (5 if RS changes).
+ * @note   Most modules drive their data pins with 5 V when RW is high. Do not
+ *         connect RW to a GPIO of a 3.3 V board without level shifting; tie it
+ *         to GND and set Rw to HD44780_LINUX_NO_LINE instead.
+ * @note   Ioctl is optional. If it is set, all requests are sent to it instead
+ *         of ioctl() (e.g. a mock for tests) and Chip can be NULL.
+ */
+typedef struct HD44780_Platform_s
+{
+  const char *Chip;   // e.g. "/dev/gpiochip0"
+  uint32_t Rs;
+  uint32_t Rw;
+  uint32_t E;
+  uint32_t D[4];
+  int (*Ioctl)(int Fd, unsigned long Request, void *Arg);
+
+  int ChipFd;
+  int LineFd;
+  uint64_t Image;     // values of the lines (bit: index in the request)
+  uint64_t Sent;      // values last written to the lines
+  uint64_t ReadyNs;   // lines must not change before this time
+  uint32_t Syscalls;  // number of ioctl calls (statistics)
+  uint8_t Lines;      // number of requested lines
+  uint8_t Input;      // data lines are inputs
+} HD44780_Platform_t;
+
+
+
+/**
+ ==================================================================================
+                             ##### Functions #####                                 
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize platform device to communicate HD44780 through the Linux
+ *         GPIO character device.
+ * @note   Platform must remain valid while the handler is in use. The lines
+ *         are requested from the kernel and held until
+ *         HD44780_Platform_DeInit().
+ * @param  Handler: Pointer to handler
+ * @param  Platform: Pointer to GPIO transport
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: The chip could not be opened or the lines could not
+ *                         be requested (e.g. they are in use).
+ */
+HD44780_Result_t
+HD44780_Platform_Init(HD44780_Handler_t *Handler, HD44780_Platform_t *Platform);
+
+/**
+ * @brief  Release the lines and close the chip
+ * @param  Platform: Pointer to GPIO transport
+ * @retval None
+ */
+void
+HD44780_Platform_DeInit(HD44780_Platform_t *Platform);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //! _HD44780_PLATFORM_H_
@@ -30,7 +30,39 @@
 
 /* Includes ---------------------------------------------------------------------*/
 #include "HD44780_platform.h"
-#include "main.h"
+#include <stddef.h>
+
+
+/* Private Macro ----------------------------------------------------------------*/
+// Cycle counter is available on Cortex-M3 and above
+#if defined(DWT) && defined(CoreDebug)
+#define HD44780_PLATFORM_CYCCNT 1
+#else
+#define HD44780_PLATFORM_CYCCNT 0
+#endif
+
+
+
+/* Private Variables ------------------------------------------------------------*/
+static HD44780_Platform_t HD44780_DefaultPins =
+{
+  {HD44780_RS_GPIO_PORT, HD44780_RS_GPIO_PIN},
+  {HD44780_RW_GPIO_PORT, HD44780_RW_GPIO_PIN},
+  {HD44780_E_GPIO_PORT, HD44780_E_GPIO_PIN},
+  {
+    {HD44780_D4_GPIO_PORT, HD44780_D4_GPIO_PIN},
+    {HD44780_D5_GPIO_PORT, HD44780_D5_GPIO_PIN},
+    {HD44780_D6_GPIO_PORT, HD44780_D6_GPIO_PIN},
+    {HD44780_D7_GPIO_PORT, HD44780_D7_GPIO_PIN}
+  },
+  {{0}}, 0, 0, 0 // set by HD44780_Platform_InitPins()
+};
+
+#if (HD44780_PLATFORM_CYCCNT)
+// Microsecond clock built from the cycle counter, wraps at 2^32 us
+static uint32_t HD44780_TimeUs = 0;
+static uint32_t HD44780_TimeCycles = 0; // counter value already accounted
+#endif
 
 
 
@@ -64,92 +96,257 @@ SetGPIO_IN(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin)
 
 
 static void
-PlatformInitRsRwE(void)
+PlatformInitRsRwE(void *Context)
 {
-  SetGPIO_OUT(HD44780_RS_GPIO_PORT, HD44780_RS_GPIO_PIN);
-  SetGPIO_OUT(HD44780_RW_GPIO_PORT, HD44780_RW_GPIO_PIN);
-  SetGPIO_OUT(HD44780_E_GPIO_PORT, HD44780_E_GPIO_PIN);
+  const HD44780_Platform_t *Pins = (const HD44780_Platform_t *)Context;
+
+  SetGPIO_OUT(Pins->Rs.Port, Pins->Rs.Pin);
+  SetGPIO_OUT(Pins->Rw.Port, Pins->Rw.Pin);
+  SetGPIO_OUT(Pins->E.Port, Pins->E.Pin);
+
+#if (HD44780_PLATFORM_CYCCNT)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
 }
 
 static void
-PlatformSetValRs(uint8_t Level)
+PlatformSetValRs(void *Context, uint8_t Level)
 {
-  HAL_GPIO_WritePin(HD44780_RS_GPIO_PORT, HD44780_RS_GPIO_PIN, Level);
+  const HD44780_Platform_t *Pins = (const HD44780_Platform_t *)Context;
+  HAL_GPIO_WritePin(Pins->Rs.Port, Pins->Rs.Pin, Level);
 }
 
 static void
-PlatformSetValRw(uint8_t Level)
+PlatformSetValRw(void *Context, uint8_t Level)
 {
-  HAL_GPIO_WritePin(HD44780_RW_GPIO_PORT, HD44780_RW_GPIO_PIN, Level);
+  const HD44780_Platform_t *Pins = (const HD44780_Platform_t *)Context;
+  HAL_GPIO_WritePin(Pins->Rw.Port, Pins->Rw.Pin, Level);
 }
 
 static void
-PlatformSetValE(uint8_t Level)
+PlatformSetValE(void *Context, uint8_t Level)
 {
-  HAL_GPIO_WritePin(HD44780_E_GPIO_PORT, HD44780_E_GPIO_PIN, Level);
+  const HD44780_Platform_t *Pins = (const HD44780_Platform_t *)Context;
+  HAL_GPIO_WritePin(Pins->E.Port, Pins->E.Pin, Level);
 }
 
 static void
-PlatformSetDirData(uint8_t Dir)
+PlatformSetDirData(void *Context, uint8_t Dir)
 {
-  if (Dir)
+  HD44780_Platform_t *Pins = (HD44780_Platform_t *)Context;
+  uint8_t i;
+
+  // Reconfiguring pins is slow, skip it if direction is not changed
+  Dir = Dir ? 1 : 0;
+  if (Pins->Dir == Dir)
+    return;
+  Pins->Dir = Dir;
+
+  if (Pins->PortCount == 0)
   {
-    SetGPIO_OUT(HD44780_D4_GPIO_PORT, HD44780_D4_GPIO_PIN);
-    SetGPIO_OUT(HD44780_D5_GPIO_PORT, HD44780_D5_GPIO_PIN);
-    SetGPIO_OUT(HD44780_D6_GPIO_PORT, HD44780_D6_GPIO_PIN);
-    SetGPIO_OUT(HD44780_D7_GPIO_PORT, HD44780_D7_GPIO_PIN);
+    for (i = 0; i < 4; i++)
+    {
+      if (Dir)
+        SetGPIO_OUT(Pins->D[i].Port, Pins->D[i].Pin);
+      else
+        SetGPIO_IN(Pins->D[i].Port, Pins->D[i].Pin);
+    }
+    return;
   }
-  else
+
+  for (i = 0; i < Pins->PortCount; i++)
   {
-    SetGPIO_IN(HD44780_D4_GPIO_PORT, HD44780_D4_GPIO_PIN);
-    SetGPIO_IN(HD44780_D5_GPIO_PORT, HD44780_D5_GPIO_PIN);
-    SetGPIO_IN(HD44780_D6_GPIO_PORT, HD44780_D6_GPIO_PIN);
-    SetGPIO_IN(HD44780_D7_GPIO_PORT, HD44780_D7_GPIO_PIN);
+    if (Dir)
+      SetGPIO_OUT(Pins->Ports[i].Port, Pins->Ports[i].Mask);
+    else
+      SetGPIO_IN(Pins->Ports[i].Port, Pins->Ports[i].Mask);
   }
 }
 
 static void
-PlatformWriteData(uint8_t Data)
+PlatformWriteData(void *Context, uint8_t Data)
 {
-  HAL_GPIO_WritePin(HD44780_D4_GPIO_PORT, HD44780_D4_GPIO_PIN, (Data & 0x10));
-  HAL_GPIO_WritePin(HD44780_D5_GPIO_PORT, HD44780_D5_GPIO_PIN, (Data & 0x20));
-  HAL_GPIO_WritePin(HD44780_D6_GPIO_PORT, HD44780_D6_GPIO_PIN, (Data & 0x40));
-  HAL_GPIO_WritePin(HD44780_D7_GPIO_PORT, HD44780_D7_GPIO_PIN, (Data & 0x80));
+  const HD44780_Platform_t *Pins = (const HD44780_Platform_t *)Context;
+  uint8_t i;
+
+  if (Pins->PortCount == 0)
+  {
+    for (i = 0; i < 4; i++)
+    {
+      HAL_GPIO_WritePin(Pins->D[i].Port, Pins->D[i].Pin,
+                        (Data & (0x10 << i)) ? GPIO_PIN_SET : GPIO_PIN_RESET);
+    }
+    return;
+  }
+
+  Data >>= 4;
+  for (i = 0; i < Pins->PortCount; i++)
+    Pins->Ports[i].Port->BSRR = Pins->Ports[i].Bsrr[Data];
 }
 
 static uint8_t
-PlatformReadData(void)
+PlatformReadData(void *Context)
 {
+  const HD44780_Platform_t *Pins = (const HD44780_Platform_t *)Context;
+  const HD44780_PlatformPort_t *port;
   uint8_t Data = 0;
+  uint8_t i;
+
+  if (Pins->PortCount == 0 || !Pins->ReadMapped)
+  {
+    for (i = 0; i < 4; i++)
+    {
+      if (HAL_GPIO_ReadPin(Pins->D[i].Port, Pins->D[i].Pin))
+        Data |= (0x10 << i);
+    }
+    return Data;
+  }
 
-  if (HAL_GPIO_ReadPin(HD44780_D4_GPIO_PORT, HD44780_D4_GPIO_PIN))
-    Data |= 0x10;
-  if (HAL_GPIO_ReadPin(HD44780_D5_GPIO_PORT, HD44780_D5_GPIO_PIN))
-    Data |= 0x20;
-  if (HAL_GPIO_ReadPin(HD44780_D6_GPIO_PORT, HD44780_D6_GPIO_PIN))
-    Data |= 0x40;
-  if (HAL_GPIO_ReadPin(HD44780_D7_GPIO_PORT, HD44780_D7_GPIO_PIN))
-    Data |= 0x80;
+  for (i = 0; i < Pins->PortCount; i++)
+  {
+    port = &Pins->Ports[i];
+    Data |= port->Get[(port->Port->IDR >> port->Shift) & 0x0F];
+  }
 
   return Data;
 }
 
 static void
-PlatformDelayMs(uint16_t Delay)
+PlatformDelayMs(void *Context, uint16_t Delay)
 {
+  (void)Context;
   HAL_Delay(Delay);
 }
 
+#if (HD44780_PLATFORM_CYCCNT)
+static void
+PlatformDelayUs(void *Context, uint16_t Delay)
+{
+  uint32_t start = DWT->CYCCNT;
+  uint32_t ticks = Delay * (SystemCoreClock / 1000000);
+  (void)Context;
+  while ((DWT->CYCCNT - start) < ticks);
+}
+
+static uint32_t
+PlatformGetTimeUs(void *Context)
+{
+  uint32_t per_us = SystemCoreClock / 1000000;
+  uint32_t elapsed;
+  (void)Context;
+
+  // CYCCNT wraps every 2^32 cycles, so only whole microseconds since the
+  // last call are added and the remaining cycles are carried to the next one
+  elapsed = (DWT->CYCCNT - HD44780_TimeCycles) / per_us;
+  HD44780_TimeCycles += elapsed * per_us;
+  HD44780_TimeUs += elapsed;
+
+  return HD44780_TimeUs;
+}
+#else
 static void
-PlatformDelayUs(uint16_t Delay)
+PlatformDelayUs(void *Context, uint16_t Delay)
 {
   uint32_t clk_freq = HAL_RCC_GetSysClockFreq();
   uint32_t ticks = (Delay * clk_freq) / 1000000;
+  (void)Context;
   for (uint32_t i = 0; i < ticks; i++)
   {
     __NOP();
   }
 }
+#endif
+
+
+static void
+PlatformMapPins(HD44780_Platform_t *Pins)
+{
+  HD44780_PlatformPort_t *port;
+  uint8_t i, j, n, bit;
+
+  // Group data pins by port
+  Pins->PortCount = 0;
+  for (i = 0; i < 4; i++)
+  {
+    for (j = 0; j < Pins->PortCount; j++)
+    {
+      if (Pins->Ports[j].Port == Pins->D[i].Port)
+        break;
+    }
+
+    if (j == Pins->PortCount)
+    {
+      if (j == HD44780_DATA_PORTS)
+      {
+        // Too many ports, access pins one by one
+        Pins->PortCount = 0;
+        return;
+      }
+
+      Pins->Ports[j].Port = Pins->D[i].Port;
+      Pins->Ports[j].Mask = 0;
+      Pins->PortCount++;
+    }
+
+    Pins->Ports[j].Mask |= Pins->D[i].Pin;
+  }
+
+  Pins->ReadMapped = 1;
+  for (j = 0; j < Pins->PortCount; j++)
+  {
+    port = &Pins->Ports[j];
+
+    port->Shift = 0;
+    while (!(port->Mask & (1U << port->Shift)))
+      port->Shift++;
+    if ((port->Mask >> port->Shift) > 0x0F)
+      Pins->ReadMapped = 0;
+
+    for (n = 0; n < 16; n++)
+    {
+      port->Bsrr[n] = 0;
+      port->Get[n] = 0;
+      for (i = 0; i < 4; i++)
+      {
+        if (Pins->D[i].Port != port->Port)
+          continue;
+
+        // Lower half of BSRR sets pins, upper half resets them
+        if (n & (1 << i))
+          port->Bsrr[n] |= Pins->D[i].Pin;
+        else
+          port->Bsrr[n] |= (uint32_t)Pins->D[i].Pin << 16;
+
+        bit = 0;
+        while (!(Pins->D[i].Pin & (1U << bit)))
+          bit++;
+        if ((bit - port->Shift) < 4 && (n & (1 << (bit - port->Shift))))
+          port->Get[n] |= (0x10 << i);
+      }
+    }
+  }
+}
+
+
+static const HD44780_OPS_SPACE HD44780_Ops_t HD44780_PlatformOps =
+{
+  PlatformInitRsRwE,
+  PlatformSetValRs,
+  PlatformSetValRw,
+  PlatformSetValE,
+  PlatformSetDirData,
+  PlatformWriteData,
+  PlatformReadData,
+  PlatformDelayMs,
+  PlatformDelayUs,
+  NULL, // pin changes are not buffered
+#if (HD44780_PLATFORM_CYCCNT)
+  PlatformGetTimeUs
+#else
+  NULL  // no free-running counter
+#endif
+};
 
 
 
@@ -161,19 +358,32 @@ PlatformDelayUs(uint16_t Delay)
 
 /**
  * @brief  Initialize platform device to communicate HD44780.
+ * @note   The pins defined in HD44780_platform.h are used.
  * @param  Handler: Pointer to handler
  * @retval None
  */
 void
 HD44780_Platform_Init(HD44780_Handler_t *Handler)
 {
-  Handler->PlatformInitRsRwE = PlatformInitRsRwE;
-  Handler->PlatformSetValRs = PlatformSetValRs;
-  Handler->PlatformSetValRw = PlatformSetValRw;
-  Handler->PlatformSetValE = PlatformSetValE;
-  Handler->PlatformSetDirData = PlatformSetDirData;
-  Handler->PlatformWriteData = PlatformWriteData;
-  Handler->PlatformReadData = PlatformReadData;
-  Handler->PlatformDelayMs = PlatformDelayMs;
-  Handler->PlatformDelayUs = PlatformDelayUs;
+  HD44780_Platform_InitPins(Handler, &HD44780_DefaultPins);
+}
+
+/**
+ * @brief  Initialize platform device to communicate HD44780 with a custom pin
+ *         set. Useful when several displays are connected.
+ * @note   Pins must remain valid while the handler is in use. Lookup tables
+ *         of the data pins are computed and stored in it.
+ * @param  Handler: Pointer to handler
+ * @param  Pins: Pointer to pin set of the display
+ * @retval None
+ */
+void
+HD44780_Platform_InitPins(HD44780_Handler_t *Handler,
+                          HD44780_Platform_t *Pins)
+{
+  PlatformMapPins(Pins);
+  Pins->Dir = 0xFF; // unknown
+
+  Handler->Ops = &HD44780_PlatformOps;
+  Handler->Context = Pins;
 }
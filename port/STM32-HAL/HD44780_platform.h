@@ -39,6 +39,7 @@ extern "C" {
 
 /* Includes ---------------------------------------------------------------------*/
 #include "HD44780.h"
+#include "main.h"
 
 
 /* Functionality Options --------------------------------------------------------*/
@@ -57,6 +58,55 @@ extern "C" {
 #define HD44780_D7_GPIO_PORT        GPIOA
 #define HD44780_D7_GPIO_PIN         GPIO_PIN_6
 
+/**
+ * @brief  Maximum number of ports the data pins are spread over. Each port
+ *         costs 88 bytes of RAM per display for lookup tables. If the data
+ *         pins use more ports, they are accessed one by one (slower).
+ */
+#define HD44780_DATA_PORTS          2
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  Pin data type
+ */
+typedef struct HD44780_PlatformPin_s
+{
+  GPIO_TypeDef *Port;
+  uint16_t Pin;
+} HD44780_PlatformPin_t;
+
+/**
+ * @brief  Data pins of one port with lookup tables to access them at once
+ */
+typedef struct HD44780_PlatformPort_s
+{
+  GPIO_TypeDef *Port;
+  uint16_t Mask;      // data pins of this port
+  uint8_t Shift;      // lowest data pin of this port
+  uint32_t Bsrr[16];  // BSRR value for each value of D7..D4
+  uint8_t Get[16];    // D7..D4 (as high nibble) for each 4 input bits from Shift
+} HD44780_PlatformPort_t;
+
+/**
+ * @brief  Pin set of one display. Passed to the platform functions as context.
+ * @note   D[0] is D4 and D[3] is D7.
+ * @note   Ports, PortCount, ReadMapped and Dir are set by
+ *         HD44780_Platform_InitPins().
+ */
+typedef struct HD44780_Platform_s
+{
+  HD44780_PlatformPin_t Rs;
+  HD44780_PlatformPin_t Rw;
+  HD44780_PlatformPin_t E;
+  HD44780_PlatformPin_t D[4];
+
+  HD44780_PlatformPort_t Ports[HD44780_DATA_PORTS];
+  uint8_t PortCount;  // 0: data pins are accessed one by one
+  uint8_t ReadMapped; // data pins of each port fit in 4 consecutive bits
+  uint8_t Dir;        // current direction of data pins
+} HD44780_Platform_t;
+
 
 
 /**
@@ -67,12 +117,26 @@ extern "C" {
 
 /**
  * @brief  Initialize platform device to communicate HD44780.
+ * @note   The pins defined in this file are used.
  * @param  Handler: Pointer to handler
  * @retval None
  */
 void
 HD44780_Platform_Init(HD44780_Handler_t *Handler);
 
+/**
+ * @brief  Initialize platform device to communicate HD44780 with a custom pin
+ *         set. Useful when several displays are connected.
+ * @note   Pins must remain valid while the handler is in use. Lookup tables
+ *         of the data pins are computed and stored in it.
+ * @param  Handler: Pointer to handler
+ * @param  Pins: Pointer to pin set of the display
+ * @retval None
+ */
+void
+HD44780_Platform_InitPins(HD44780_Handler_t *Handler,
+                          HD44780_Platform_t *Pins);
+
 
 #ifdef __cplusplus
 }
@@ -68,10 +68,50 @@
 #define HD44780_START_LINE2  0x40 // DDRAM address of first char of line 2
 #define HD44780_START_LINE3  0x14 // DDRAM address of first char of line 3
 #define HD44780_START_LINE4  0x54 // DDRAM address of first char of line 4
+#define HD44780_END_LINE1    0x28 // DDRAM address after last char of line 1
+#define HD44780_END_LINE2    0x68 // DDRAM address after last char of line 2
+#define HD44780_LINE_RAM     (HD44780_END_LINE1 - HD44780_START_LINE1)
 
 #define HD44780_FUNCTION_DEFAULT  Hd44780_FUNCTION_4BIT_2LINES
 #define HD44780_MODE_DEFAULT  ((1<<HD44780_ENTRY_MODE) | (1<<HD44780_ENTRY_INC))
 
+#if (HD44780_CONFIG_TIMING_PRESETS)
+#define HD44780_TIMING_PRESETS  5
+#else
+#define HD44780_TIMING_PRESETS  1
+#endif
+
+// calibration: measured time may not exceed this multiple of the preset value
+#define HD44780_CALIBRATE_LIMIT 8
+
+// calibration: measured time may not go below this percentage of the preset
+// value (fastest oscillator of the datasheet, 350 kHz instead of 270 kHz)
+#define HD44780_CALIBRATE_FLOOR 75
+
+// tracked address when the address counter does not point to a known DDRAM cell
+#define HD44780_ADDRESS_UNKNOWN 0x80
+
+
+
+/* Private Variables ------------------------------------------------------------*/
+/**
+ * @brief  Built-in timing profiles. Execution times are data sheet values at
+ *         the nominal oscillator frequency. The slow profile covers modules
+ *         powered from 3.3 V which are up to three times slower.
+ */
+static const HD44780_Timing_t
+HD44780_TimingPresets[HD44780_TIMING_PRESETS] HD44780_PROGMEM =
+{
+  // PowerOn, EPulse, ECycle, Address, Poll, Sync, Command, Data, Clear, Home
+  [HD44780_TIMING_HD44780U] = {15, 1, 1, 4, 10, 4100, 37, 41, 1520, 1520},
+#if (HD44780_CONFIG_TIMING_PRESETS)
+  [HD44780_TIMING_ST7066U]  = {40, 1, 1, 4, 10, 4100, 37, 43, 1520, 1520},
+  [HD44780_TIMING_SPLC780D] = {40, 1, 1, 4, 10, 4100, 39, 43, 1530, 1530},
+  [HD44780_TIMING_KS0066]   = {30, 1, 1, 4, 10, 4100, 39, 43, 1530, 1530},
+  [HD44780_TIMING_SLOW]     = {50, 1, 1, 12, 10, 12300, 120, 130, 4600, 4600},
+#endif
+};
+
 
 
 /**
@@ -79,160 +119,1103 @@
                            ##### Private Functions #####                           
  ==================================================================================
  */
-
-static void
-HD44780_ToggleE(HD44780_Handler_t *Handler)
+
+static inline void
+HD44780_DelayUs(HD44780_Handler_t *Handler, uint16_t Delay)
+{
+  if (Delay)
+    Handler->Ops->PlatformDelayUs(Handler->Context, Delay);
+}
+
+static inline void
+HD44780_Flush(HD44780_Handler_t *Handler)
+{
+  if (Handler->Ops->PlatformFlush)
+    Handler->Ops->PlatformFlush(Handler->Context);
+}
+
+static inline void
+HD44780_Record(HD44780_Handler_t *Handler,
+               uint8_t Call, const uint8_t *Args, uint8_t Size)
+{
+#if (HD44780_CONFIG_RECORD)
+  if (Handler->Record)
+    Handler->Record(Handler->RecordContext, Call, Args, Size);
+#else
+  (void)Handler;
+  (void)Call;
+  (void)Args;
+  (void)Size;
+#endif
+}
+
+#if (HD44780_CONFIG_RECORD)
+// Report arguments of the last recorded call in pieces
+static void
+HD44780_RecordBytes(HD44780_Handler_t *Handler,
+                    const uint8_t *Data, uint16_t Size, uint8_t Flash)
+{
+  uint8_t piece[16];
+  uint8_t n = 0;
+
+  if (Handler->Record == NULL)
+    return;
+
+  while (Size--)
+  {
+    piece[n++] = Flash ? HD44780_READ_FLASH(Data) : *Data;
+    Data++;
+    if (n == sizeof(piece) || Size == 0)
+    {
+      HD44780_Record(Handler, HD44780_CALL_MORE, piece, n);
+      n = 0;
+    }
+  }
+}
+#endif
+
+// Report text argument of the last recorded call
+static void
+HD44780_RecordText(HD44780_Handler_t *Handler,
+                   const char *Str, uint8_t Len, uint8_t Flash)
+{
+#if (HD44780_CONFIG_RECORD)
+  uint16_t size = 0; // text longer than 255 bytes is dropped by the recorder
+
+  if (Handler->Record == NULL)
+    return;
+
+  while ((Flash ? HD44780_READ_FLASH(Str + size) : (uint8_t)Str[size]) != 0)
+  {
+    size++;
+    if (size == Len)
+      break;
+  }
+
+  HD44780_RecordBytes(Handler, (const uint8_t *)Str, size, Flash);
+#else
+  (void)Handler;
+  (void)Str;
+  (void)Len;
+  (void)Flash;
+#endif
+}
+
+static void
+HD44780_ToggleE(HD44780_Handler_t *Handler)
+{
+  Handler->Ops->PlatformSetValE(Handler->Context, 1);
+  HD44780_DelayUs(Handler, Handler->Timing.EnablePulseUs);
+  Handler->Ops->PlatformSetValE(Handler->Context, 0);
+}
+
+#if (HD44780_CONFIG_READ)
+static uint8_t
+HD44780_Read(HD44780_Handler_t *Handler, uint8_t RS)
+{
+  uint8_t data = 0;
+
+  // Buffered output must reach the bus before reading
+  HD44780_Flush(Handler);
+
+  if (RS)
+    Handler->Ops->PlatformSetValRs(Handler->Context, 1); // RS=1: read data
+  else
+    Handler->Ops->PlatformSetValRs(Handler->Context, 0); // RS=0: read busy flag
+
+  Handler->Ops->PlatformSetValRw(Handler->Context, 1);   // RW=1  read mode
+
+  // Read high nibble first
+  Handler->Ops->PlatformSetDirData(Handler->Context, 0);
+  Handler->Ops->PlatformSetValE(Handler->Context, 1);
+  HD44780_DelayUs(Handler, Handler->Timing.EnablePulseUs);
+  data = Handler->Ops->PlatformReadData(Handler->Context) & 0xF0;
+  Handler->Ops->PlatformSetValE(Handler->Context, 0);
+
+  HD44780_DelayUs(Handler, Handler->Timing.EnableCycleUs);
+
+  // Read low nibble
+  Handler->Ops->PlatformSetValE(Handler->Context, 1);
+  HD44780_DelayUs(Handler, Handler->Timing.EnablePulseUs);
+  data |= Handler->Ops->PlatformReadData(Handler->Context) >> 4;
+  Handler->Ops->PlatformSetValE(Handler->Context, 0);
+
+  return data;
+}
+#endif
+
+static void
+HD44780_StepAddress(HD44780_Handler_t *Handler, uint8_t Inc)
+{
+  uint8_t address = Handler->Address;
+
+  if (address & HD44780_ADDRESS_UNKNOWN)
+    return;
+
+  if (Inc)
+  {
+    address++;
+    if (address == HD44780_END_LINE1)
+      address = HD44780_START_LINE2;
+    else if (address == HD44780_END_LINE2)
+      address = HD44780_START_LINE1;
+  }
+  else
+  {
+    if (address == HD44780_START_LINE1)
+      address = HD44780_END_LINE2 - 1;
+    else if (address == HD44780_START_LINE2)
+      address = HD44780_END_LINE1 - 1;
+    else
+      address--;
+  }
+
+  Handler->Address = address;
+}
+
+// DDRAM offset of the page addressed by HD44780_GoToXY()
+static inline uint8_t
+HD44780_PageOffset(HD44780_Handler_t *Handler)
+{
+  return Handler->Page * Handler->Length;
+}
+
+static void
+HD44780_UpdateState(HD44780_Handler_t *Handler, uint8_t Data, uint8_t RS)
+{
+  if (RS)
+  {
+    HD44780_StepAddress(Handler, Handler->EntryMode & (1 << HD44780_ENTRY_INC));
+    Handler->PendingUs = Handler->Timing.DataUs;
+    return;
+  }
+
+  Handler->PendingUs = Handler->Timing.CommandUs;
+
+  if (Data & (1 << HD44780_DDRAM))
+  {
+    Handler->Address = Data & 0x7F;
+  }
+  else if (Data & (1 << HD44780_CGRAM))
+  {
+    // Address counter points to CGRAM, DDRAM position is no longer known
+    Handler->Address = HD44780_ADDRESS_UNKNOWN;
+  }
+  else if (Data & (1 << HD44780_FUNCTION))
+  {
+  }
+  else if (Data & (1 << HD44780_MOVE))
+  {
+    if (!(Data & (1 << HD44780_MOVE_DISP)))
+      HD44780_StepAddress(Handler, Data & (1 << HD44780_MOVE_RIGHT));
+    else if (Data & (1 << HD44780_MOVE_RIGHT))
+      Handler->Shift = Handler->Shift ? Handler->Shift - 1 : HD44780_LINE_RAM - 1;
+    else
+      Handler->Shift = (Handler->Shift + 1) % HD44780_LINE_RAM;
+  }
+  else if (Data & (1 << HD44780_ON))
+  {
+    Handler->Display = Data;
+  }
+  else if (Data & (1 << HD44780_ENTRY_MODE))
+  {
+    Handler->EntryMode = Data;
+  }
+  else if (Data & (1 << HD44780_HOME))
+  {
+    Handler->Address = HD44780_START_LINE1;
+    Handler->Shift = 0;
+    Handler->PendingUs = Handler->Timing.HomeUs;
+  }
+  else if (Data & (1 << HD44780_CLR))
+  {
+    Handler->Address = HD44780_START_LINE1;
+    Handler->Shift = 0;
+    Handler->EntryMode |= (1 << HD44780_ENTRY_INC);
+    Handler->PendingUs = Handler->Timing.ClearUs;
+  }
+}
+
+static void
+HD44780_SetDeadline(HD44780_Handler_t *Handler)
+{
+  if (Handler->Ops->PlatformGetTimeUs)
+  {
+    Handler->ReadyAt = Handler->Ops->PlatformGetTimeUs(Handler->Context) +
+                       Handler->PendingUs;
+  }
+}
+
+static uint16_t
+HD44780_RemainingUs(HD44780_Handler_t *Handler)
+{
+  int32_t remaining;
+
+  if (Handler->Ops->PlatformGetTimeUs == NULL || Handler->PendingUs == 0)
+    return Handler->PendingUs;
+
+  remaining = (int32_t)(Handler->ReadyAt -
+                        Handler->Ops->PlatformGetTimeUs(Handler->Context));
+  if (remaining <= 0)
+    return 0;
+
+  // Never wait longer than the execution time (e.g. if the counter wrapped)
+  if (remaining > Handler->PendingUs)
+    return Handler->PendingUs;
+
+  return remaining;
+}
+
+static void
+HD44780_WriteNibble(HD44780_Handler_t *Handler, uint8_t Data)
+{
+  Handler->Ops->PlatformSetValRs(Handler->Context, 0);
+  Handler->Ops->PlatformSetValRw(Handler->Context, 0);
+  Handler->Ops->PlatformSetDirData(Handler->Context, 1);
+  Handler->Ops->PlatformWriteData(Handler->Context, Data & 0xF0);
+  HD44780_ToggleE(Handler);
+}
+
+static void
+HD44780_Write(HD44780_Handler_t *Handler, uint8_t Data, uint8_t RS)
+{
+  if (RS)
+  {
+    // Write data
+    Handler->Ops->PlatformSetValRs(Handler->Context, 1);
+  }
+  else
+  {
+    // Write instruction
+    Handler->Ops->PlatformSetValRs(Handler->Context, 0);
+  }
+
+  // Write mode
+  Handler->Ops->PlatformSetValRw(Handler->Context, 0);
+  Handler->Ops->PlatformSetDirData(Handler->Context, 1);
+
+  // Write high nibble first
+  Handler->Ops->PlatformWriteData(Handler->Context, Data & 0xF0);
+  HD44780_ToggleE(Handler);
+
+  HD44780_DelayUs(Handler, Handler->Timing.EnableCycleUs);
+
+  // Write low nibble
+  Handler->Ops->PlatformWriteData(Handler->Context, (Data << 4) & 0xF0);
+  HD44780_ToggleE(Handler);
+
+  // All data pins high (inactive)
+  Handler->Ops->PlatformWriteData(Handler->Context, 0xFF);
+
+  HD44780_UpdateState(Handler, Data, RS);
+  HD44780_SetDeadline(Handler);
+}
+
+#if (HD44780_CONFIG_READ)
+static void
+HD44780_Fail(HD44780_Handler_t *Handler, uint8_t Error)
+{
+  Handler->Fault |= Error;
+  Handler->Errors |= Error;
+}
+#endif
+
+// Wait for execution time of last instruction
+static uint8_t
+HD44780_WaitTime(HD44780_Handler_t *Handler)
+{
+  HD44780_DelayUs(Handler, HD44780_RemainingUs(Handler));
+  Handler->PendingUs = 0;
+  return Handler->Address & ~HD44780_ADDRESS_UNKNOWN;
+}
+
+static uint8_t
+HD44780_WaitBusy(HD44780_Handler_t *Handler)
+{
+#if (HD44780_CONFIG_READ)
+  uint32_t limit;
+  uint32_t elapsed = 0;
+  uint8_t address;
+
+  // After an error the busy flag is not trusted until the end of operation
+  if (Handler->Ops->PlatformReadData == NULL ||
+      (Handler->Options & HD44780_OPT_TIMED) ||
+      Handler->Fault)
+#endif
+  {
+    // Busy flag is not readable, wait for execution time of last instruction
+    return HD44780_WaitTime(Handler);
+  }
+
+#if (HD44780_CONFIG_READ)
+
+  limit = Handler->BusyTimeoutUs;
+  if (limit == 0)
+    limit = HD44780_CALIBRATE_LIMIT * (uint32_t)Handler->Timing.ClearUs;
+
+  // Wait until busy flag is cleared
+  while (HD44780_Read(Handler, 0) & (1 << HD44780_BUSY))
+  {
+    HD44780_DelayUs(Handler, Handler->Timing.PollUs);
+    elapsed += Handler->Timing.PollUs + 2 * Handler->Timing.EnablePulseUs +
+               Handler->Timing.EnableCycleUs;
+    if (elapsed > limit)
+    {
+      HD44780_Fail(Handler, HD44780_ERR_TIMEOUT);
+      Handler->PendingUs = 0;
+      return Handler->Address & ~HD44780_ADDRESS_UNKNOWN;
+    }
+  }
+
+  // The address counter is updated after the busy flag is cleared
+  HD44780_DelayUs(Handler, Handler->Timing.AddressUs);
+  Handler->PendingUs = 0;
+
+  // Now read the address counter. A lost or extra nibble shows up as an
+  // address other than the one tracked by software.
+  address = HD44780_Read(Handler, 0) & 0x7F;
+  if (!(Handler->Address & HD44780_ADDRESS_UNKNOWN) &&
+      address != Handler->Address)
+    HD44780_Fail(Handler, HD44780_ERR_DESYNC);
+
+  return address;
+#endif
+}
+
+static void
+HD44780_SendCommand(HD44780_Handler_t *Handler, uint8_t Cmd)
+{
+  HD44780_WaitBusy(Handler);
+  HD44780_Write(Handler, Cmd, 0);
+}
+
+static void
+HD44780_SendData(HD44780_Handler_t *Handler, uint8_t Data)
+{
+  HD44780_WaitBusy(Handler);
+  HD44780_Write(Handler, Data, 1);
+}
+
+static void
+HD44780_SetAddress(HD44780_Handler_t *Handler, uint8_t X, uint8_t Y)
+{
+  X += HD44780_PageOffset(Handler);
+
+  switch (Y)
+  {
+  case 0:
+    HD44780_SendCommand(Handler, (1 << HD44780_DDRAM) + HD44780_START_LINE1 + X);
+    break;
+
+  case 1:
+    HD44780_SendCommand(Handler, (1 << HD44780_DDRAM) + HD44780_START_LINE2 + X);
+    break;
+
+  case 2:
+    HD44780_SendCommand(Handler, (1 << HD44780_DDRAM) + HD44780_START_LINE3 + X);
+    break;
+
+  case 3:
+    HD44780_SendCommand(Handler, (1 << HD44780_DDRAM) + HD44780_START_LINE4 + X);
+    break;
+  }
+}
+
+// Shift the display until the first visible column is Target
+static void
+HD44780_ShiftTo(HD44780_Handler_t *Handler, uint8_t Target)
+{
+  uint8_t count;
+  uint8_t cmd;
+  uint8_t address;
+
+  count = (Target + HD44780_LINE_RAM - Handler->Shift) % HD44780_LINE_RAM;
+  cmd = HD44780_MOVE_DISP_LEFT;
+  if (count > HD44780_LINE_RAM / 2)
+  {
+    count = HD44780_LINE_RAM - count;
+    cmd = HD44780_MOVE_DISP_RIGHT;
+  }
+
+  if (Target == 0 && count > 1 &&
+      Handler->Timing.HomeUs < (uint32_t)count * Handler->Timing.CommandUs)
+  {
+    address = HD44780_WaitBusy(Handler);
+    HD44780_Write(Handler, 1 << HD44780_HOME, 0);
+    HD44780_SendCommand(Handler, (1 << HD44780_DDRAM) | address);
+    return;
+  }
+
+  while (count--)
+    HD44780_SendCommand(Handler, cmd);
+}
+
+#if (HD44780_CONFIG_READ)
+static uint16_t
+HD44780_MeasureBusy(HD44780_Handler_t *Handler, uint8_t Data, uint8_t RS,
+                    uint16_t Limit)
+{
+  uint16_t readUs;
+  uint16_t elapsed = 0;
+  uint32_t start = 0;
+
+  // Time spent for a busy flag read (at least)
+  readUs = 2 * Handler->Timing.EnablePulseUs + Handler->Timing.EnableCycleUs;
+
+  // Make sure the previous instruction is finished
+  HD44780_WaitBusy(Handler);
+  if (Handler->Fault)
+    return 0;
+
+  HD44780_Write(Handler, Data, RS);
+  if (Handler->Ops->PlatformGetTimeUs)
+    start = Handler->Ops->PlatformGetTimeUs(Handler->Context);
+
+  while (HD44780_Read(Handler, 0) & (1 << HD44780_BUSY))
+  {
+    Handler->Ops->PlatformDelayUs(Handler->Context, 1);
+    elapsed += 1 + readUs;
+    if (Handler->Ops->PlatformGetTimeUs)
+      elapsed = Handler->Ops->PlatformGetTimeUs(Handler->Context) - start;
+    if (elapsed > Limit)
+      return 0;
+  }
+
+  // The real time includes the platform calls and ends after the last read.
+  // Without it, only the nominal delays are counted.
+  if (Handler->Ops->PlatformGetTimeUs)
+    return Handler->Ops->PlatformGetTimeUs(Handler->Context) - start;
+
+  return elapsed + readUs;
+}
+
+static inline uint16_t
+HD44780_CalibrateLimit(uint16_t Time)
+{
+  uint32_t limit = (uint32_t)Time * HD44780_CALIBRATE_LIMIT;
+
+  return (limit > 0xF000) ? 0xF000 : limit;
+}
+
+static inline uint16_t
+HD44780_AddMargin(uint16_t Time, uint16_t Extra)
+{
+  return Time + (Time / 4) + Extra;
+}
+
+// Calibrated value of a time from its measurement and its preset value
+static uint16_t
+HD44780_Calibrated(HD44780_Handler_t *Handler, uint16_t Measured,
+                   uint16_t Preset, uint16_t Extra)
+{
+  uint16_t time = HD44780_AddMargin(Measured, Extra);
+  uint16_t floor = Preset;
+
+  // Without PlatformGetTimeUs the time spent in the platform calls is not
+  // counted, so the measurement is a lower bound and can only make the
+  // profile slower
+  if (Handler->Ops->PlatformGetTimeUs)
+    floor = (uint32_t)Preset * HD44780_CALIBRATE_FLOOR / 100;
+
+  return (time < floor) ? floor : time;
+}
+
+static HD44780_Result_t
+HD44780_Measure(HD44780_Handler_t *Handler)
+{
+  HD44780_Timing_t *timing = &Handler->Timing;
+  uint16_t clearUs;
+  uint16_t commandUs;
+  uint16_t dataUs;
+
+  clearUs = HD44780_MeasureBusy(Handler, 1 << HD44780_CLR, 0,
+                                HD44780_CalibrateLimit(timing->ClearUs));
+  commandUs = HD44780_MeasureBusy(Handler, HD44780_MOVE_CURSOR_RIGHT, 0,
+                                  HD44780_CalibrateLimit(timing->CommandUs));
+  HD44780_SendCommand(Handler, HD44780_MOVE_CURSOR_LEFT);
+  dataUs = HD44780_MeasureBusy(Handler, ' ', 1,
+                               HD44780_CalibrateLimit(timing->DataUs));
+  HD44780_SendCommand(Handler, (1 << HD44780_DDRAM) + HD44780_START_LINE1);
+
+  if (clearUs == 0 || commandUs == 0 || dataUs == 0)
+    return HD44780_FAIL;
+
+  // Busy flag is polled with 1us steps, add the step and 25% margin
+  timing->ClearUs = HD44780_Calibrated(Handler, clearUs, timing->ClearUs, 1);
+  timing->HomeUs = timing->ClearUs;
+  timing->CommandUs = HD44780_Calibrated(Handler, commandUs,
+                                         timing->CommandUs, 1);
+  timing->DataUs = HD44780_Calibrated(Handler, dataUs, timing->DataUs,
+                                      1 + timing->AddressUs);
+
+  // Last instruction was the address set
+  Handler->PendingUs = timing->CommandUs;
+  HD44780_SetDeadline(Handler);
+
+  return HD44780_OK;
+}
+#endif
+
+static HD44780_Result_t
+HD44780_Setup(HD44780_Handler_t *Handler, uint8_t Lines, uint8_t Length)
+{
+  if (Handler->Ops == NULL)
+    return HD44780_FAIL;
+
+  if (Handler->Ops->PlatformInitRsRwE)
+    Handler->Ops->PlatformInitRsRwE(Handler->Context);
+
+  if (Handler->Ops->PlatformSetValRs == NULL ||
+      Handler->Ops->PlatformSetValRw == NULL ||
+      Handler->Ops->PlatformSetValE == NULL ||
+      Handler->Ops->PlatformSetDirData == NULL ||
+      Handler->Ops->PlatformWriteData == NULL ||
+      Handler->Ops->PlatformDelayMs == NULL ||
+      Handler->Ops->PlatformDelayUs == NULL)
+    return HD44780_FAIL;
+
+  if (Handler->Timing.CommandUs == 0)
+    HD44780_COPY_FLASH(&Handler->Timing,
+                       &HD44780_TimingPresets[HD44780_TIMING_HD44780U],
+                       sizeof(Handler->Timing));
+
+  Handler->Lines = Lines;
+  Handler->Length = Length;
+  Handler->Address = HD44780_ADDRESS_UNKNOWN;
+  Handler->EntryMode = HD44780_MODE_DEFAULT;
+  Handler->Page = 0;
+  Handler->Shift = 0;
+  Handler->Display = HD44780_DISP_OFF;
+  Handler->Fault = 0;
+  Handler->ScrubPos = 0;
+
+  return HD44780_OK;
+}
+
+static void
+HD44780_Sync(HD44780_Handler_t *Handler, uint16_t FirstWaitUs)
+{
+  HD44780_WriteNibble(Handler, 0x30);
+  HD44780_DelayUs(Handler, FirstWaitUs);
+  HD44780_WriteNibble(Handler, 0x30);
+  HD44780_DelayUs(Handler, Handler->Timing.CommandUs);
+  HD44780_WriteNibble(Handler, 0x30);
+  HD44780_DelayUs(Handler, Handler->Timing.CommandUs);
+  HD44780_WriteNibble(Handler, 0x20);
+  HD44780_DelayUs(Handler, Handler->Timing.CommandUs);
+  Handler->PendingUs = 0;
+}
+
+#if (HD44780_CONFIG_READ) && \
+    ((HD44780_CONFIG_WARM_INIT) || (HD44780_CONFIG_SCRUB))
+static uint8_t
+HD44780_ReadRam(HD44780_Handler_t *Handler)
+{
+  uint8_t data;
+
+  HD44780_WaitBusy(Handler);
+  data = HD44780_Read(Handler, 1);
+  HD44780_StepAddress(Handler, Handler->EntryMode & (1 << HD44780_ENTRY_INC));
+  Handler->PendingUs = Handler->Timing.DataUs;
+  HD44780_SetDeadline(Handler);
+
+  return data;
+}
+#endif
+
+#if (HD44780_CONFIG_WARM_INIT) || (HD44780_CONFIG_SCRUB)
+static uint8_t
+HD44780_Repair(HD44780_Handler_t *Handler,
+               uint8_t X, uint8_t Y, const char *Expected, uint8_t Count)
+{
+  uint8_t mismatches = 0;
+  uint8_t readable = 0;
+  uint8_t i;
+
+#if (HD44780_CONFIG_READ)
+  readable = (Handler->Ops->PlatformReadData != NULL);
+#endif
+
+  HD44780_SetAddress(Handler, X, Y);
+  for (i = 0; i < Count; i++)
+  {
+#if (HD44780_CONFIG_READ)
+    if (readable && HD44780_ReadRam(Handler) == (uint8_t)Expected[i])
+      continue;
+#endif
+
+    // Address counter passed this cell while reading it
+    if (readable)
+      HD44780_SetAddress(Handler, X + i, Y);
+
+    HD44780_SendData(Handler, Expected[i]);
+    mismatches++;
+
+    // The first read after a data write returns invalid data, so the next
+    // cell is read after an address set
+    if (readable && i + 1 < Count)
+      HD44780_SetAddress(Handler, X + i + 1, Y);
+  }
+
+  return mismatches;
+}
+#endif
+
+#if (HD44780_CONFIG_NEWLINE)
+static inline void
+HD44780_NewLine(HD44780_Handler_t *Handler, uint8_t Pos)
+{
+  register uint8_t addressCounter;
+
+  if (Handler->Lines <= 2)
+  {
+    // Next line of the same page
+    addressCounter = (Pos < HD44780_START_LINE2) ?
+                     HD44780_START_LINE2 : HD44780_START_LINE1;
+    addressCounter += HD44780_PageOffset(Handler);
+  }
+  else if (Pos < HD44780_START_LINE3)
+    addressCounter = HD44780_START_LINE2;
+  else if ((Pos >= HD44780_START_LINE2) && (Pos < HD44780_START_LINE4))
+    addressCounter = HD44780_START_LINE3;
+  else if ((Pos >= HD44780_START_LINE3) && (Pos < HD44780_START_LINE2))
+    addressCounter = HD44780_START_LINE4;
+  else
+    addressCounter = HD44780_START_LINE1;
+
+  // Busy flag is already checked by the caller
+  HD44780_Write(Handler, (1 << HD44780_DDRAM) + addressCounter, 0);
+}
+#endif
+
+static void
+HD44780_PutChar(HD44780_Handler_t *Handler, char C)
+{
+#if (HD44780_CONFIG_NEWLINE)
+  uint8_t pos;
+
+  pos = HD44780_WaitBusy(Handler);   // read busy-flag and address counter
+  if (C == '\n')
+  {
+    HD44780_NewLine(Handler, pos);
+  }
+  else
+  {
+    HD44780_Write(Handler, C, 1);
+  }
+#else
+  HD44780_WaitBusy(Handler);
+  HD44780_Write(Handler, C, 1);
+#endif
+}
+
+// Flash: 1 if Str is in program memory
+static void
+HD44780_PutStr(HD44780_Handler_t *Handler,
+               const char *Str, uint8_t Len, uint8_t Flash)
+{
+  register char c;
+
+  for (;;)
+  {
+    c = Flash ? (char)HD44780_READ_FLASH(Str) : *Str;
+    if (c == 0)
+      break;
+    HD44780_PutChar(Handler, c);
+    Str++;
+    if (Len && --Len == 0)
+      break;
+  }
+}
+
+#if (HD44780_CONFIG_CGRAM)
+// Flash: 1 if Pattern is in program memory
+static void
+HD44780_DefineChar(HD44780_Handler_t *Handler,
+                   uint8_t Location, const uint8_t *Pattern, uint8_t Flash)
+{
+  uint8_t args[9];  // Location, pattern
+  uint8_t address;
+  uint8_t i;
+
+  args[0] = Location;
+  for (i = 0; i < 8; i++)
+    args[i + 1] = Flash ? HD44780_READ_FLASH(&Pattern[i]) : Pattern[i];
+  HD44780_Record(Handler, HD44780_CALL_CREATE_CHAR, args, sizeof(args));
+
+  address = HD44780_WaitBusy(Handler);
+  HD44780_Write(Handler, (1 << HD44780_CGRAM) | ((Location & 0x07) << 3), 0);
+  for (i = 0; i < 8; i++)
+    HD44780_SendData(Handler, args[i + 1] & 0x1F);
+  HD44780_SendCommand(Handler, (1 << HD44780_DDRAM) | address);
+}
+#endif
+
+#if (HD44780_CONFIG_READ)
+static void
+HD44780_Recover(HD44780_Handler_t *Handler)
+{
+  uint8_t address = Handler->Address;
+  uint8_t shift = Handler->Shift;
+  uint8_t page = Handler->Page;
+  uint8_t x, y;
+
+  // Fault is still set, so only execution times are waited for
+  HD44780_Sync(Handler, Handler->Timing.ClearUs > Handler->Timing.HomeUs ?
+                        Handler->Timing.ClearUs : Handler->Timing.HomeUs);
+  HD44780_SendCommand(Handler, HD44780_FUNCTION_DEFAULT);
+  HD44780_SendCommand(Handler, Handler->EntryMode);
+  HD44780_SendCommand(Handler, Handler->Display);
+  HD44780_SendCommand(Handler, 1 << HD44780_HOME);
+  HD44780_ShiftTo(Handler, shift);
+
+  if (Handler->Screen)
+  {
+    // Rewrite the visible page
+    if (Handler->Length)
+      Handler->Page = shift / Handler->Length;
+    for (y = 0; y < Handler->Lines; y++)
+    {
+      HD44780_SetAddress(Handler, 0, y);
+      for (x = 0; x < Handler->Length; x++)
+        HD44780_SendData(Handler, Handler->Screen[y * Handler->Length + x]);
+    }
+    Handler->Page = page;
+  }
+
+  if (!(address & HD44780_ADDRESS_UNKNOWN))
+    HD44780_SendCommand(Handler, (1 << HD44780_DDRAM) | address);
+}
+#endif
+
+// End of a public operation: send buffered output and report errors
+static HD44780_Result_t
+HD44780_Finish(HD44780_Handler_t *Handler)
+{
+  HD44780_Flush(Handler);
+
+#if (HD44780_CONFIG_READ)
+  if (Handler->Fault == 0)
+    return HD44780_OK;
+
+  if (Handler->Options & HD44780_OPT_RECOVER)
+  {
+    HD44780_Recover(Handler);
+    HD44780_Flush(Handler);
+  }
+
+  Handler->Fault = 0;
+  return HD44780_FAIL;
+#else
+  return HD44780_OK;
+#endif
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  
+ * @param  Handler: Pointer to handler
+ * @param  Lines: Number of lines
+ * @param  Length: Number of characters in a line
+ * @param  DispAttr: Display attributes
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_Init(HD44780_Handler_t *Handler,
+             uint8_t Lines, uint8_t Length,
+             uint8_t DispAttr)
+{
+  const uint8_t args[4] = {Lines, Length, DispAttr, Handler->Options};
+
+  HD44780_Record(Handler, HD44780_CALL_INIT, args, sizeof(args));
+
+  if (HD44780_Setup(Handler, Lines, Length) != HD44780_OK)
+    return HD44780_FAIL;
+
+  Handler->Ops->PlatformDelayMs(Handler->Context, Handler->Timing.PowerOnMs);
+
+  // Change to 4 bit I/O mode (busy flag can not be checked yet)
+  HD44780_Sync(Handler, Handler->Timing.SyncUs);
+
+  HD44780_SendCommand(Handler, HD44780_FUNCTION_DEFAULT); // function set: display lines
+  HD44780_SendCommand(Handler, HD44780_DISP_OFF);         // display off
+  HD44780_SendCommand(Handler, 1 << HD44780_CLR);         // display clear
+  HD44780_SendCommand(Handler, HD44780_MODE_DEFAULT);     // set entry mode
+  HD44780_SendCommand(Handler, DispAttr);             // display/cursor control
+
+#if (HD44780_CONFIG_READ)
+  if ((Handler->Options & HD44780_OPT_CALIBRATE) && Handler->Fault == 0 &&
+      Handler->Ops->PlatformReadData != NULL)
+  {
+    if (HD44780_Measure(Handler) != HD44780_OK)
+    {
+      HD44780_Finish(Handler);
+      return HD44780_FAIL;
+    }
+  }
+#endif
+
+  return HD44780_Finish(Handler);
+}
+
+#if (HD44780_CONFIG_WARM_INIT)
+/**
+ * @brief  Resume a display that is already powered and initialized (e.g. after
+ *         a watchdog reset of the MCU) without clearing the screen.
+ * @note   The 4-bit interface is re-synchronized and function, entry mode and
+ *         display settings are restored. The cursor is moved to home position.
+ *         HD44780_OPT_CALIBRATE is ignored.
+ * @param  Handler: Pointer to handler
+ * @param  Lines: Number of lines
+ * @param  Length: Number of characters in a line
+ * @param  DispAttr: Display attributes
+ * @param  Expected: Expected screen content (Lines * Length characters, line
+ *                   after line). If the busy flag is readable, only the cells
+ *                   that differ from DDRAM are written, otherwise all cells are
+ *                   written. If NULL, current content is kept.
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_WarmInit(HD44780_Handler_t *Handler,
+                 uint8_t Lines, uint8_t Length,
+                 uint8_t DispAttr, const char *Expected)
 {
-  Handler->PlatformSetValE(1);
-  Handler->PlatformDelayUs(1);
-  Handler->PlatformSetValE(0);
-}
+  const uint8_t args[4] = {Lines, Length, DispAttr, Handler->Options};
+  uint8_t y;
 
-static uint8_t
-HD44780_Read(HD44780_Handler_t *Handler, uint8_t RS)
-{
-  uint8_t data = 0;
+  HD44780_Record(Handler, HD44780_CALL_WARM_INIT, args, sizeof(args));
+  if (Expected)
+    HD44780_RecordText(Handler, Expected, Lines * Length, 0);
 
-  if (RS)
-    Handler->PlatformSetValRs(1); // RS=1: read data
-  else
-    Handler->PlatformSetValRs(0); // RS=0: read busy flag
+  if (HD44780_Setup(Handler, Lines, Length) != HD44780_OK)
+    return HD44780_FAIL;
 
-  Handler->PlatformSetValRw(1);   // RW=1  read mode
+  // The interface may be in the middle of a byte. The first nibble of sync
+  // sequence may complete an unknown instruction, none of them clears DDRAM.
+  HD44780_Sync(Handler, Handler->Timing.ClearUs > Handler->Timing.HomeUs ?
+                        Handler->Timing.ClearUs : Handler->Timing.HomeUs);
 
-  // Read high nibble first
-  Handler->PlatformSetDirData(0);
-  Handler->PlatformSetValE(1);
-  Handler->PlatformDelayUs(1);
-  data = Handler->PlatformReadData() & 0xF0;
-  Handler->PlatformSetValE(0);
+  HD44780_SendCommand(Handler, HD44780_FUNCTION_DEFAULT); // function set: display lines
+  HD44780_SendCommand(Handler, HD44780_MODE_DEFAULT);     // set entry mode
+  HD44780_SendCommand(Handler, DispAttr);             // display/cursor control
 
-  Handler->PlatformDelayUs(1);
+  if (Expected)
+  {
+    for (y = 0; y < Lines; y++)
+      HD44780_Repair(Handler, 0, y, Expected + (uint16_t)y * Length, Length);
+  }
 
-  // Read low nibble
-  Handler->PlatformSetValE(1);
-  Handler->PlatformDelayUs(1);
-  data |= Handler->PlatformReadData() >> 4;
-  Handler->PlatformSetValE(0);
+  HD44780_SendCommand(Handler, 1 << HD44780_HOME);
 
-  return data;
+  return HD44780_Finish(Handler);
 }
+#endif
 
-static void
-HD44780_Write(HD44780_Handler_t *Handler, uint8_t Data, uint8_t RS)
+#if (HD44780_CONFIG_SCRUB)
+/**
+ * @brief  Check a few cells of the screen against Handler->Screen and rewrite
+ *         the ones that differ
+ * @note   Each call continues where the previous one stopped and cycles
+ *         through the whole screen, so it can be called from an idle loop to
+ *         repair characters corrupted by noise. The cost of a call is bounded
+ *         by Count. If the busy flag is not readable, the cells are rewritten
+ *         without checking. When the cycle restarts, function, entry mode and
+ *         display settings are sent again. The cursor is preserved.
+ * @param  Handler: Pointer to handler
+ * @param  Count: Number of cells to check
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Handler->Screen is not set, or failed to send or
+ *                         receive data.
+ */
+HD44780_Result_t
+HD44780_Scrub(HD44780_Handler_t *Handler, uint8_t Count)
 {
-  if (RS)
+  uint8_t cells = Handler->Lines * Handler->Length;
+  uint8_t page = Handler->Page;
+  uint8_t address;
+  uint8_t x, y, n;
+
+  HD44780_Record(Handler, HD44780_CALL_SCRUB, &Count, 1);
+
+  if (Handler->Screen == NULL || cells == 0)
+    return HD44780_FAIL;
+
+  address = Handler->Address;
+  if (Handler->ScrubPos >= cells)
+    Handler->ScrubPos = 0;
+
+  // Undo mode changes (e.g. a corrupted instruction) once per cycle
+  if (Handler->ScrubPos == 0)
   {
-    // Write data
-    Handler->PlatformSetValRs(1);
+    HD44780_SendCommand(Handler, HD44780_FUNCTION_DEFAULT);
+    HD44780_SendCommand(Handler, Handler->EntryMode);
+    HD44780_SendCommand(Handler, Handler->Display);
   }
-  else
+
+  // Check the visible page
+  Handler->Page = Handler->Shift / Handler->Length;
+  while (Count)
   {
-    // Write instruction
-    Handler->PlatformSetValRs(0);
-  }
+    // One row at most per step
+    x = Handler->ScrubPos % Handler->Length;
+    y = Handler->ScrubPos / Handler->Length;
+    n = Handler->Length - x;
+    if (n > Count)
+      n = Count;
 
-  // Write mode
-  Handler->PlatformSetValRw(0);
-  Handler->PlatformSetDirData(1);
+    HD44780_Repair(Handler, x, y, Handler->Screen + Handler->ScrubPos, n);
 
-  // Write high nibble first
-  Handler->PlatformWriteData(Data & 0xF0);
-  HD44780_ToggleE(Handler);
+    Count -= n;
+    Handler->ScrubPos += n;
+    if (Handler->ScrubPos >= cells)
+    {
+      Handler->ScrubPos = 0;
+      break;
+    }
+  }
+  Handler->Page = page;
 
-  // Write low nibble
-  Handler->PlatformWriteData((Data << 4) & 0xF0);
-  HD44780_ToggleE(Handler);
+  if (!(address & HD44780_ADDRESS_UNKNOWN))
+    HD44780_SendCommand(Handler, (1 << HD44780_DDRAM) | address);
 
-  // All data pins high (inactive)
-  Handler->PlatformWriteData(0xFF);
+  return HD44780_Finish(Handler);
 }
+#endif
 
-static uint8_t
-HD44780_WaitBusy(HD44780_Handler_t *Handler)
+/**
+ * @brief  Select one of built-in timing profiles
+ * @note   Call this function before HD44780_Init(). HD44780_TIMING_HD44780U
+ *         is used if no timing profile is set.
+ * @param  Handler: Pointer to handler
+ * @param  Preset: Timing profile
+ *         - HD44780_TIMING_HD44780U
+ *         - HD44780_TIMING_ST7066U
+ *         - HD44780_TIMING_SPLC780D
+ *         - HD44780_TIMING_KS0066
+ *         - HD44780_TIMING_SLOW
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Unknown timing profile.
+ */
+HD44780_Result_t
+HD44780_SetTimingPreset(HD44780_Handler_t *Handler, uint8_t Preset)
 {
-  register uint8_t c;
+  HD44780_Record(Handler, HD44780_CALL_TIMING_PRESET, &Preset, 1);
 
-  // Wait until busy flag is cleared
-  while ((c = HD44780_Read(Handler, 0)) & (1 << HD44780_BUSY))
-    Handler->PlatformDelayMs(1);
+  if (Preset >= HD44780_TIMING_PRESETS)
+    return HD44780_FAIL;
 
-  // The address counter is updated 4us after the busy flag is cleared
-  Handler->PlatformDelayUs(2);
+  HD44780_COPY_FLASH(&Handler->Timing, &HD44780_TimingPresets[Preset],
+                     sizeof(Handler->Timing));
 
-  // Now read the address counter
-  return (HD44780_Read(Handler, 0)); // Return address counter
+  return HD44780_OK;
 }
 
-static inline void
-HD44780_NewLine(HD44780_Handler_t *Handler, uint8_t Pos)
+/**
+ * @brief  Set a custom timing profile
+ * @note   Call this function before HD44780_Init().
+ * @param  Handler: Pointer to handler
+ * @param  Timing: Pointer to timing profile. It is copied into the handler.
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Invalid timing profile.
+ */
+HD44780_Result_t
+HD44780_SetTiming(HD44780_Handler_t *Handler, const HD44780_Timing_t *Timing)
 {
-  register uint8_t addressCounter;
+  const uint8_t args[15] =
+  {
+    Timing->PowerOnMs, Timing->EnablePulseUs, Timing->EnableCycleUs,
+    Timing->AddressUs, Timing->PollUs,
+    Timing->SyncUs & 0xFF, Timing->SyncUs >> 8,
+    Timing->CommandUs & 0xFF, Timing->CommandUs >> 8,
+    Timing->DataUs & 0xFF, Timing->DataUs >> 8,
+    Timing->ClearUs & 0xFF, Timing->ClearUs >> 8,
+    Timing->HomeUs & 0xFF, Timing->HomeUs >> 8
+  };
 
-  if (Pos < HD44780_START_LINE3)
-    addressCounter = HD44780_START_LINE2;
-  else if ((Pos >= HD44780_START_LINE2) && (Pos < HD44780_START_LINE4))
-    addressCounter = HD44780_START_LINE3;
-  else if ((Pos >= HD44780_START_LINE3) && (Pos < HD44780_START_LINE2))
-    addressCounter = HD44780_START_LINE4;
-  else
-    addressCounter = HD44780_START_LINE1;
+  HD44780_Record(Handler, HD44780_CALL_TIMING, args, sizeof(args));
 
-  HD44780_Command(Handler, (1 << HD44780_DDRAM) + addressCounter);
-}
+  if (Timing->CommandUs == 0 || Timing->DataUs == 0 ||
+      Timing->ClearUs == 0 || Timing->HomeUs == 0)
+    return HD44780_FAIL;
 
+  Handler->Timing = *Timing;
 
+  return HD44780_OK;
+}
 
 /**
- ==================================================================================
-                            ##### Public Functions #####                           
- ==================================================================================
+ * @brief  Get the time of each operation from the timing profile
+ * @note   Use it after HD44780_Init() (and calibration) to choose between
+ *         ways of updating the screen, e.g. with HD44780_DList_Plan().
+ * @param  Handler: Pointer to handler
+ * @param  Cost: Pointer to cost model that receives the times
+ * @retval None
  */
+void
+HD44780_GetCost(HD44780_Handler_t *Handler, HD44780_Cost_t *Cost)
+{
+  const HD44780_Timing_t *timing = &Handler->Timing;
+  uint16_t transfer;
+
+  // Two nibbles
+  transfer = 2 * timing->EnablePulseUs + timing->EnableCycleUs;
+
+#if (HD44780_CONFIG_READ)
+  // Busy flag and address counter are read before each write
+  if (Handler->Ops->PlatformReadData != NULL &&
+      !(Handler->Options & HD44780_OPT_TIMED))
+    transfer += 2 * transfer + timing->AddressUs;
+#endif
 
+  Cost->CommandUs = timing->CommandUs + transfer;
+  Cost->DataUs = timing->DataUs + transfer;
+  Cost->ClearUs = timing->ClearUs + transfer;
+}
+
+#if (HD44780_CONFIG_READ)
 /**
- * @brief  
+ * @brief  Measure how long the module keeps the busy flag set for clear,
+ *         cursor move and data write, and store the results (with safety
+ *         margin) in the timing profile of handler.
+ * @note   The display is cleared. The measured times are used in timed mode
+ *         (HD44780_OPT_TIMED).
  * @param  Handler: Pointer to handler
- * @param  Lines: Number of lines
- * @param  Length: Number of characters in a line
- * @param  DispAttr: Display attributes
  * @retval HD44780_Result_t
  *         - HD44780_OK: Operation was successful.
- *         - HD44780_FAIL: Failed to send or receive data.
+ *         - HD44780_FAIL: Busy flag is not readable or it did not clear in
+ *                         time. The timing profile is not changed.
  */
 HD44780_Result_t
-HD44780_Init(HD44780_Handler_t *Handler,
-             uint8_t Lines, uint8_t Length,
-             uint8_t DispAttr)
+HD44780_Calibrate(HD44780_Handler_t *Handler)
 {
+  HD44780_Result_t result;
 
-  if (Handler->PlatformInitRsRwE)
-    Handler->PlatformInitRsRwE();
+  HD44780_Record(Handler, HD44780_CALL_CALIBRATE, NULL, 0);
 
-  if (Handler->PlatformSetValRs == NULL ||
-      Handler->PlatformSetValRw == NULL ||
-      Handler->PlatformSetValE == NULL ||
-      Handler->PlatformSetDirData == NULL ||
-      Handler->PlatformWriteData == NULL ||
-      Handler->PlatformReadData == NULL ||
-      Handler->PlatformDelayMs == NULL ||
-      Handler->PlatformDelayUs == NULL)
+  if (Handler->Ops->PlatformReadData == NULL)
     return HD44780_FAIL;
 
-  Handler->Lines = Lines;
-  Handler->Length = Length;
-
-  // Change to 4 bit I/O mode
-  HD44780_Write(Handler, 0x33, 0);
-  HD44780_Write(Handler, 0x32, 0);
-
-  HD44780_Command(Handler, HD44780_FUNCTION_DEFAULT); // function set: display lines
-  HD44780_Command(Handler, HD44780_DISP_OFF);         // display off
-  HD44780_ClearScreen(Handler);                   // display clear
-  HD44780_Command(Handler, HD44780_MODE_DEFAULT);     // set entry mode
-  HD44780_Command(Handler, DispAttr);             // display/cursor control
+  result = HD44780_Measure(Handler);
+  if (HD44780_Finish(Handler) != HD44780_OK)
+    return HD44780_FAIL;
 
-  return HD44780_OK;
+  return result;
 }
+#endif
 
 /**
  * @brief  Clear display and set cursor to home position
@@ -244,9 +1227,10 @@ HD44780_Init(HD44780_Handler_t *Handler,
 HD44780_Result_t
 HD44780_ClearScreen(HD44780_Handler_t *Handler)
 {
-  HD44780_Command(Handler, 1 << HD44780_CLR);
+  HD44780_Record(Handler, HD44780_CALL_CLEAR, NULL, 0);
+  HD44780_SendCommand(Handler, 1 << HD44780_CLR);
 
-  return HD44780_OK;
+  return HD44780_Finish(Handler);
 }
 
 /**
@@ -259,9 +1243,10 @@ HD44780_ClearScreen(HD44780_Handler_t *Handler)
 HD44780_Result_t
 HD44780_Home(HD44780_Handler_t *Handler)
 {
-  HD44780_Command(Handler, 1 << HD44780_HOME);
+  HD44780_Record(Handler, HD44780_CALL_HOME, NULL, 0);
+  HD44780_SendCommand(Handler, 1 << HD44780_HOME);
 
-  return HD44780_OK;
+  return HD44780_Finish(Handler);
 }
 
 /**
@@ -276,28 +1261,82 @@ HD44780_Home(HD44780_Handler_t *Handler)
 HD44780_Result_t
 HD44780_GoToXY(HD44780_Handler_t *Handler, uint8_t X, uint8_t Y)
 {
-  switch (Y)
-  {
-  case 0:
-    HD44780_Command(Handler, (1 << HD44780_DDRAM) + HD44780_START_LINE1 + X);
-    break;
+  const uint8_t args[2] = {X, Y};
 
-  case 1:
-    HD44780_Command(Handler, (1 << HD44780_DDRAM) + HD44780_START_LINE2 + X);
-    break;
+  HD44780_Record(Handler, HD44780_CALL_GOTOXY, args, sizeof(args));
+  HD44780_SetAddress(Handler, X, Y);
 
-  case 2:
-    HD44780_Command(Handler, (1 << HD44780_DDRAM) + HD44780_START_LINE3 + X);
-    break;
+  return HD44780_Finish(Handler);
+}
 
-  case 3:
-    HD44780_Command(Handler, (1 << HD44780_DDRAM) + HD44780_START_LINE4 + X);
-    break;
-  }
+/**
+ * @brief  Get number of pages that fit in DDRAM
+ * @note   Each DDRAM line holds 40 characters. On 1 and 2 line displays, the
+ *         invisible part of the lines is used as more pages of Length
+ *         characters (e.g. 2 pages on a 16x2 display). 4 line displays have
+ *         only one page.
+ * @param  Handler: Pointer to handler
+ * @retval Number of pages
+ */
+uint8_t
+HD44780_PageCount(HD44780_Handler_t *Handler)
+{
+  if (Handler->Lines > 2 || Handler->Length == 0)
+    return 1;
+
+  return HD44780_LINE_RAM / Handler->Length;
+}
+
+/**
+ * @brief  Select the page written by next functions
+ * @note   Positions of HD44780_GoToXY() (and functions using it) are
+ *         translated to the selected page. The next screen can be prepared
+ *         on a hidden page and then shown by HD44780_ShowPage(). The cursor
+ *         is not moved.
+ * @param  Handler: Pointer to handler
+ * @param  Page: Page number (0 to HD44780_PageCount() - 1)
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Invalid page.
+ */
+HD44780_Result_t
+HD44780_SetPage(HD44780_Handler_t *Handler, uint8_t Page)
+{
+  HD44780_Record(Handler, HD44780_CALL_SET_PAGE, &Page, 1);
+
+  if (Page >= HD44780_PageCount(Handler))
+    return HD44780_FAIL;
+
+  Handler->Page = Page;
 
   return HD44780_OK;
 }
 
+/**
+ * @brief  Make a page visible
+ * @note   The display is shifted to the page by the shorter direction, or
+ *         returned home if that is faster (page 0 only). The cursor position
+ *         and DDRAM content are preserved. HD44780_ClearScreen() and
+ *         HD44780_Home() show page 0.
+ * @param  Handler: Pointer to handler
+ * @param  Page: Page number (0 to HD44780_PageCount() - 1)
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Invalid page.
+ */
+HD44780_Result_t
+HD44780_ShowPage(HD44780_Handler_t *Handler, uint8_t Page)
+{
+  HD44780_Record(Handler, HD44780_CALL_SHOW_PAGE, &Page, 1);
+
+  if (Page >= HD44780_PageCount(Handler))
+    return HD44780_FAIL;
+
+  HD44780_ShiftTo(Handler, Page * Handler->Length);
+
+  return HD44780_Finish(Handler);
+}
+
 /**
  * @brief  Display character at current cursor position
  * @param  Handler: Pointer to handler
@@ -309,25 +1348,100 @@ HD44780_GoToXY(HD44780_Handler_t *Handler, uint8_t X, uint8_t Y)
 HD44780_Result_t
 HD44780_Putc(HD44780_Handler_t *Handler, char C)
 {
-  uint8_t pos;
+  HD44780_Record(Handler, HD44780_CALL_PUTC, (const uint8_t *)&C, 1);
+  HD44780_PutChar(Handler, C);
 
-  pos = HD44780_WaitBusy(Handler);   // read busy-flag and address counter
-  if (C == '\n')
+  return HD44780_Finish(Handler);
+}
+
+/**
+ * @brief  Display string without auto linefeed
+ * @param  Handler: Pointer to handler
+ * @param  Str: String to display
+ * @param  Len: Length of string. If 0, string will be displayed until null
+ *              character.
+ * 
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_Puts(HD44780_Handler_t *Handler, const char *Str, uint8_t Len)
+{
+  HD44780_Record(Handler, HD44780_CALL_PUTS, NULL, 0);
+  HD44780_RecordText(Handler, Str, Len, 0);
+
+  HD44780_PutStr(Handler, Str, Len, 0);
+
+  return HD44780_Finish(Handler);
+}
+
+/**
+ * @brief  Display several strings as one continuous text
+ * @note   The cursor is set once and the segments are written back to back,
+ *         so a line can be composed from a label, a value and a unit without
+ *         copying them into a buffer. Characters are written as they are
+ *         ('\n' is not interpreted).
+ * @param  Handler: Pointer to handler
+ * @param  Segments: Array of segments
+ * @param  Count: Number of segments
+ * @param  X: Start column
+ * @param  Y: Start line, or HD44780_CURRENT_POS to start at the cursor (X is
+ *            ignored)
+ * @param  Width: If not 0, exactly Width characters are written: the text is
+ *                padded with spaces or truncated.
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_Putv(HD44780_Handler_t *Handler,
+             const HD44780_Segment_t *Segments, uint8_t Count,
+             uint8_t X, uint8_t Y, uint8_t Width)
+{
+  const uint8_t args[3] = {X, Y, Width};
+  const char *p;
+  uint8_t len;
+  uint8_t written = 0;
+  uint8_t i;
+
+  HD44780_Record(Handler, HD44780_CALL_PUTV, args, sizeof(args));
+  for (i = 0; i < Count; i++)
+    HD44780_RecordText(Handler, Segments[i].Str, Segments[i].Len, 0);
+
+  if (Y != HD44780_CURRENT_POS)
+    HD44780_SetAddress(Handler, X, Y);
+
+  for (; Count; Count--, Segments++)
   {
-    HD44780_NewLine(Handler, pos);
+    p = Segments->Str;
+    len = Segments->Len;
+    while (*p)
+    {
+      if (Width && written == Width)
+        break;
+      HD44780_SendData(Handler, *p++);
+      written++;
+      if (len && --len == 0)
+        break;
+    }
   }
-  else
+
+  while (written < Width)
   {
-    HD44780_Write(Handler, C, 1);
+    HD44780_SendData(Handler, ' ');
+    written++;
   }
 
-  return HD44780_OK;
+  return HD44780_Finish(Handler);
 }
 
 /**
- * @brief  Display string without auto linefeed
+ * @brief  Display string stored in program memory without auto linefeed
+ * @note   Same as HD44780_Puts(), but Str must be declared with HD44780_PROGMEM.
+ *         Characters are read from flash one by one while they are sent.
  * @param  Handler: Pointer to handler
- * @param  Str: String to display
+ * @param  Str: String to display (in program memory)
  * @param  Len: Length of string. If 0, string will be displayed until null
  *              character.
  * 
@@ -336,29 +1450,93 @@ HD44780_Putc(HD44780_Handler_t *Handler, char C)
  *         - HD44780_FAIL: Failed to send or receive data.
  */
 HD44780_Result_t
-HD44780_Puts(HD44780_Handler_t *Handler, char *Str, uint8_t Len)
+HD44780_Puts_P(HD44780_Handler_t *Handler, const char *Str, uint8_t Len)
 {
-  register char c;
+  HD44780_Record(Handler, HD44780_CALL_PUTS, NULL, 0);
+  HD44780_RecordText(Handler, Str, Len, 1);
+
+  HD44780_PutStr(Handler, Str, Len, 1);
+
+  return HD44780_Finish(Handler);
+}
+
+/**
+ * @brief  Display a whole screen template stored in program memory
+ * @note   Template holds Lines rows of Length characters each (no line
+ *         terminators), e.g. a 2x16 template is 32 characters. It is useful
+ *         for static parts of a screen whose values are written afterwards.
+ *         The cursor is left at the end of the last line.
+ * @param  Handler: Pointer to handler
+ * @param  Template: Characters of the screen (in program memory)
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_PutScreen_P(HD44780_Handler_t *Handler, const char *Template)
+{
+  uint8_t x, y;
+
+  HD44780_Record(Handler, HD44780_CALL_PUT_SCREEN, NULL, 0);
+  HD44780_RecordText(Handler, Template, Handler->Lines * Handler->Length, 1);
 
-  if (Len == 0)
+  for (y = 0; y < Handler->Lines; y++)
   {
-    while ((c = *Str++))
-    {
-      HD44780_Putc(Handler, c);
-    }
+    HD44780_SetAddress(Handler, 0, y);
+    for (x = 0; x < Handler->Length; x++)
+      HD44780_SendData(Handler, HD44780_READ_FLASH(Template++));
   }
-  else
+
+  return HD44780_Finish(Handler);
+}
+
+/**
+ * @brief  Display a screen described by HD44780_STATIC_SCREEN()
+ * @note   The cursor is set once for each run. The busy flag (and address
+ *         counter) is checked before each cursor move; characters of a run
+ *         are written back to back after the data write time of the timing
+ *         profile. Other cells are not changed. The cursor is left after the
+ *         last run.
+ * @param  Handler: Pointer to handler
+ * @param  Screen: Pointer to the screen (in program memory)
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_PutStatic(HD44780_Handler_t *Handler, const void *Screen)
+{
+  const uint8_t *run = (const uint8_t *)Screen;
+  uint8_t len;
+  uint8_t pos;
+
+#if (HD44780_CONFIG_RECORD)
+  if (Handler->Record)
+  {
+    while ((len = HD44780_READ_FLASH(run)) != 0)
+      run += 2 + len;
+    HD44780_Record(Handler, HD44780_CALL_PUT_STATIC, NULL, 0);
+    HD44780_RecordBytes(Handler, (const uint8_t *)Screen,
+                        run - (const uint8_t *)Screen + 1, 1);
+    run = (const uint8_t *)Screen;
+  }
+#endif
+
+  while ((len = HD44780_READ_FLASH(run)) != 0)
   {
-    while (Len--)
+    pos = HD44780_READ_FLASH(run + 1);
+    run += 2;
+    HD44780_SetAddress(Handler, pos & 0x3F, pos >> 6);
+
+    while (len--)
     {
-      c = *Str++;
-      if (c == 0)
-        break;
-      HD44780_Putc(Handler, c);
+      HD44780_WaitTime(Handler);
+      HD44780_Write(Handler, HD44780_READ_FLASH(run), 1);
+      run++;
     }
   }
 
-  return HD44780_OK;
+  return HD44780_Finish(Handler);
 }
 
 /**
@@ -372,10 +1550,10 @@ HD44780_Puts(HD44780_Handler_t *Handler, char *Str, uint8_t Len)
 HD44780_Result_t
 HD44780_Command(HD44780_Handler_t *Handler, uint8_t Cmd)
 {
-  HD44780_WaitBusy(Handler);
-  HD44780_Write(Handler, Cmd, 0);
+  HD44780_Record(Handler, HD44780_CALL_COMMAND, &Cmd, 1);
+  HD44780_SendCommand(Handler, Cmd);
 
-  return HD44780_OK;
+  return HD44780_Finish(Handler);
 }
 
 /**
@@ -390,8 +1568,51 @@ HD44780_Command(HD44780_Handler_t *Handler, uint8_t Cmd)
 HD44780_Result_t
 HD44780_Data(HD44780_Handler_t *Handler, uint8_t Data)
 {
-  HD44780_WaitBusy(Handler);
-  HD44780_Write(Handler, Data, 1);
+  HD44780_Record(Handler, HD44780_CALL_DATA, &Data, 1);
+  HD44780_SendData(Handler, Data);
 
-  return HD44780_OK;
+  return HD44780_Finish(Handler);
+}
+
+#if (HD44780_CONFIG_CGRAM)
+/**
+ * @brief  Define a custom character in CGRAM
+ * @note   The cursor position is preserved.
+ * @param  Handler: Pointer to handler
+ * @param  Location: CGRAM location (0 to 7). The character is displayed by
+ *                   writing this code (or Location + 8) as data.
+ * @param  Pattern: 8 bytes, one per row from top to bottom. Lower 5 bits are
+ *                  the pixels of the row.
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_CreateChar(HD44780_Handler_t *Handler,
+                   uint8_t Location, const uint8_t *Pattern)
+{
+  HD44780_DefineChar(Handler, Location, Pattern, 0);
+
+  return HD44780_Finish(Handler);
+}
+
+/**
+ * @brief  Define a custom character in CGRAM from program memory
+ * @note   Same as HD44780_CreateChar(), but Pattern must be declared with
+ *         HD44780_PROGMEM.
+ * @param  Handler: Pointer to handler
+ * @param  Location: CGRAM location (0 to 7)
+ * @param  Pattern: 8 bytes, one per row from top to bottom (in program memory)
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_CreateChar_P(HD44780_Handler_t *Handler,
+                     uint8_t Location, const uint8_t *Pattern)
+{
+  HD44780_DefineChar(Handler, Location, Pattern, 1);
+
+  return HD44780_Finish(Handler);
 }
+#endif
@@ -0,0 +1,225 @@
+/**
+ **********************************************************************************
+ * @file   HD44780_bar.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Bar graphs with partial-cell custom characters
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "HD44780_bar.h"
+
+#if (HD44780_CONFIG_CGRAM)
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+// Character of cell Index when Value columns are filled
+static uint8_t
+HD44780_Bar_Cell(const HD44780_Bar_t *Bar, uint8_t Index, uint16_t Value)
+{
+  uint16_t start = (uint16_t)Index * HD44780_BAR_COLUMNS;
+
+  if (Value <= start)
+    return ' ';
+  if (Value - start >= HD44780_BAR_COLUMNS)
+    return Bar->Glyph + HD44780_BAR_COLUMNS - 1;
+
+  return Bar->Glyph + (Value - start) - 1;
+}
+
+// Write cells First to Last (inclusive) for Value columns
+static HD44780_Result_t
+HD44780_Bar_Write(HD44780_Handler_t *Handler, const HD44780_Bar_t *Bar,
+                  uint8_t First, uint8_t Last, uint16_t Value)
+{
+  HD44780_Result_t result = HD44780_OK;
+  uint8_t i;
+
+  if (HD44780_GoToXY(Handler, Bar->X + First, Bar->Y) != HD44780_OK)
+    result = HD44780_FAIL;
+
+  for (i = First; i <= Last; i++)
+  {
+    if (HD44780_Data(Handler, HD44780_Bar_Cell(Bar, i, Value)) != HD44780_OK)
+      result = HD44780_FAIL;
+  }
+
+  return result;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Load the glyphs of partially filled cells into CGRAM
+ * @note   Must be called once after HD44780_Init(). The glyphs take
+ *         HD44780_BAR_GLYPHS consecutive locations (Location to Location + 4)
+ *         and can be shared by all bars of the display. The other three
+ *         locations stay free; when the UTF-8 output is used too, give them to
+ *         it with HD44780_Utf8_SetSlots() (e.g. Location 0 and slots 5 to 7).
+ * @param  Handler: Pointer to handler
+ * @param  Location: First CGRAM location (0 to 3)
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data, or Location is out
+ *                         of range.
+ */
+HD44780_Result_t
+HD44780_Bar_LoadGlyphs(HD44780_Handler_t *Handler, uint8_t Location)
+{
+  HD44780_Result_t result = HD44780_OK;
+  uint8_t pattern[8];
+  uint8_t columns;
+  uint8_t row;
+
+  if (Location > 8 - HD44780_BAR_GLYPHS)
+    return HD44780_FAIL;
+
+  for (columns = 1; columns <= HD44780_BAR_GLYPHS; columns++)
+  {
+    // Columns are filled from the left. The last row (cursor line) stays
+    // empty, so the bar has the height of the characters.
+    for (row = 0; row < 7; row++)
+      pattern[row] = (0x1F << (HD44780_BAR_COLUMNS - columns)) & 0x1F;
+    pattern[7] = 0;
+
+    if (HD44780_CreateChar(Handler, Location + columns - 1, pattern) !=
+        HD44780_OK)
+      result = HD44780_FAIL;
+  }
+
+  return result;
+}
+
+
+/**
+ * @brief  Initialize a bar
+ * @note   Nothing is written to the display. The first call of
+ *         HD44780_Bar_Set() draws the whole bar.
+ * @param  Bar: Pointer to bar
+ * @param  X: X position of the first cell
+ * @param  Y: Line of the bar
+ * @param  Length: Length in cells
+ * @param  Glyph: Location passed to HD44780_Bar_LoadGlyphs()
+ * @retval None
+ */
+void
+HD44780_Bar_Init(HD44780_Bar_t *Bar,
+                 uint8_t X, uint8_t Y, uint8_t Length, uint8_t Glyph)
+{
+  Bar->X = X;
+  Bar->Y = Y;
+  Bar->Length = Length;
+  Bar->Glyph = Glyph;
+  Bar->Value = 0;
+  Bar->Drawn = 0;
+}
+
+
+/**
+ * @brief  Show a new value on the bar
+ * @note   Only the cells between the old and the new end of the bar are
+ *         written (one or two for a small change), so the time of an update
+ *         does not depend on the length of the bar. The cursor is left after
+ *         the last written cell.
+ * @param  Handler: Pointer to handler
+ * @param  Bar: Pointer to bar
+ * @param  Value: Value to show (0 to Max)
+ * @param  Max: Value of a full bar. If 0, Value is the number of columns
+ *              (0 to Length * 5).
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_Bar_Set(HD44780_Handler_t *Handler, HD44780_Bar_t *Bar,
+                uint16_t Value, uint16_t Max)
+{
+  uint16_t full = (uint16_t)Bar->Length * HD44780_BAR_COLUMNS;
+  uint16_t low;
+  uint16_t high;
+
+  if (Max)
+  {
+    if (Value > Max)
+      Value = Max;
+    Value = (uint16_t)(((uint32_t)Value * full + Max / 2) / Max);
+  }
+  else if (Value > full)
+  {
+    Value = full;
+  }
+
+  if (!Bar->Drawn)
+  {
+    Bar->Value = Value;
+    return HD44780_Bar_Draw(Handler, Bar);
+  }
+
+  if (Value == Bar->Value)
+    return HD44780_OK;
+
+  low = (Value < Bar->Value) ? Value : Bar->Value;
+  high = (Value < Bar->Value) ? Bar->Value : Value;
+  Bar->Value = Value;
+
+  // Only the cells holding columns low + 1 to high change
+  return HD44780_Bar_Write(Handler, Bar,
+                           low / HD44780_BAR_COLUMNS,
+                           (high - 1) / HD44780_BAR_COLUMNS, Value);
+}
+
+
+/**
+ * @brief  Draw the whole bar again
+ * @note   Call after the display has been cleared or overwritten.
+ * @param  Handler: Pointer to handler
+ * @param  Bar: Pointer to bar
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_Bar_Draw(HD44780_Handler_t *Handler, HD44780_Bar_t *Bar)
+{
+  Bar->Drawn = 1;
+  if (Bar->Length == 0)
+    return HD44780_OK;
+
+  return HD44780_Bar_Write(Handler, Bar, 0, Bar->Length - 1, Bar->Value);
+}
+
+#endif
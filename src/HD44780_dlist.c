@@ -0,0 +1,728 @@
+/**
+ **********************************************************************************
+ * @file   HD44780_dlist.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Recordable display lists with a peephole optimizer
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "HD44780_dlist.h"
+#include <string.h>
+
+
+
+/* Private Constants ------------------------------------------------------------*/
+#define HD44780_DLIST_UNKNOWN  0xFF  // cursor column is not known
+
+#define HD44780_CELL_KNOWN     0x01  // Value holds the content of the cell
+#define HD44780_CELL_PENDING   0x02  // Pending must be written to the cell
+
+
+
+/* Private Data Types -----------------------------------------------------------*/
+typedef struct HD44780_DList_State_s
+{
+  HD44780_DList_t *Dst;
+  uint8_t Lines;
+  uint8_t Length;
+  uint8_t X, Y;        // cursor after the operations of Src read so far
+  uint8_t OutX, OutY;  // cursor after the operations written to Dst
+  uint8_t Display;     // last display control instruction (0: not known)
+  uint8_t Entry;       // last entry mode instruction
+  uint8_t Full;
+  uint8_t Flags[HD44780_DLIST_CELLS];
+  uint8_t Value[HD44780_DLIST_CELLS];
+  uint8_t Pending[HD44780_DLIST_CELLS];
+} HD44780_DList_State_t;
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static HD44780_Result_t
+HD44780_DList_Append(HD44780_DList_t *List, uint8_t Code, uint8_t Arg)
+{
+  if (List->Count >= List->Size)
+    return HD44780_FAIL;
+
+  List->Entries[List->Count].Code = Code;
+  List->Entries[List->Count].Arg = Arg;
+  List->Count++;
+
+  return HD44780_OK;
+}
+
+static void
+HD44780_DList_Emit(HD44780_DList_State_t *State, uint8_t Code, uint8_t Arg)
+{
+  if (HD44780_DList_Append(State->Dst, Code, Arg) != HD44780_OK)
+    State->Full = 1;
+}
+
+static void
+HD44780_DList_Forget(HD44780_DList_State_t *State)
+{
+  memset(State->Flags, 0, sizeof(State->Flags));
+}
+
+static void
+HD44780_DList_WriteCells(HD44780_DList_State_t *State,
+                         uint8_t Y, uint8_t From, uint8_t To)
+{
+  uint8_t cell = Y * State->Length + From;
+  uint8_t x;
+
+  for (x = From; x < To; x++, cell++)
+  {
+    if (!(State->Flags[cell] & HD44780_CELL_PENDING))
+      continue;
+
+    if (State->OutX != x || State->OutY != Y)
+      HD44780_DList_Emit(State, HD44780_DLIST_POS, (Y << 6) | x);
+    HD44780_DList_Emit(State, HD44780_DLIST_DATA, State->Pending[cell]);
+    State->Value[cell] = State->Pending[cell];
+    State->Flags[cell] = HD44780_CELL_KNOWN;
+    State->OutX = x + 1;
+    State->OutY = Y;
+  }
+}
+
+// Write pending cells in runs, then move the cursor where Src left it
+static void
+HD44780_DList_Flush(HD44780_DList_State_t *State, uint8_t Restore)
+{
+  uint8_t last = State->X;
+  uint8_t y;
+
+  // The run that ends at the cursor is written last, so the cursor is
+  // already in place after it
+  if (Restore && State->X != HD44780_DLIST_UNKNOWN &&
+      (State->X == State->Length ||
+       !(State->Flags[State->Y * State->Length + State->X] &
+         HD44780_CELL_PENDING)))
+  {
+    while (last > 0 &&
+           (State->Flags[State->Y * State->Length + last - 1] &
+            HD44780_CELL_PENDING))
+      last--;
+  }
+
+  for (y = 0; y < State->Lines; y++)
+  {
+    if (last < State->X && y == State->Y)
+    {
+      HD44780_DList_WriteCells(State, y, 0, last);
+      HD44780_DList_WriteCells(State, y, State->X, State->Length);
+    }
+    else
+    {
+      HD44780_DList_WriteCells(State, y, 0, State->Length);
+    }
+  }
+
+  if (last < State->X)
+    HD44780_DList_WriteCells(State, State->Y, last, State->X);
+
+  if (Restore && State->X != HD44780_DLIST_UNKNOWN &&
+      (State->OutX != State->X || State->OutY != State->Y))
+  {
+    HD44780_DList_Emit(State, HD44780_DLIST_POS, (State->Y << 6) | State->X);
+    State->OutX = State->X;
+    State->OutY = State->Y;
+  }
+}
+
+// Write an operation as it is after the pending cells
+static void
+HD44780_DList_Keep(HD44780_DList_State_t *State, uint8_t Code, uint8_t Arg)
+{
+  HD44780_DList_Flush(State, 1);
+  HD44780_DList_Emit(State, Code, Arg);
+}
+
+// The cursor is where the original list leaves it, but it is not modeled
+static void
+HD44780_DList_LoseCursor(HD44780_DList_State_t *State)
+{
+  State->X = State->OutX = HD44780_DLIST_UNKNOWN;
+}
+
+static uint8_t
+HD44780_DList_CanModel(HD44780_DList_State_t *State)
+{
+  return State->X < State->Length && State->Entry == HD44780_ENTRY_INC_;
+}
+
+static void
+HD44780_DList_Write(HD44780_DList_State_t *State, uint8_t C)
+{
+  uint8_t cell;
+
+  if (!HD44780_DList_CanModel(State))
+  {
+    // The character may be written anywhere (even to CGRAM)
+    HD44780_DList_Keep(State, HD44780_DLIST_DATA, C);
+    HD44780_DList_Forget(State);
+    HD44780_DList_LoseCursor(State);
+    return;
+  }
+
+  cell = State->Y * State->Length + State->X;
+  if ((State->Flags[cell] & HD44780_CELL_KNOWN) && State->Value[cell] == C)
+  {
+    State->Flags[cell] &= ~HD44780_CELL_PENDING;
+  }
+  else
+  {
+    State->Pending[cell] = C;
+    State->Flags[cell] |= HD44780_CELL_PENDING;
+  }
+
+  State->X++;
+}
+
+static void
+HD44780_DList_Var(HD44780_DList_State_t *State, uint8_t Code, uint8_t Width)
+{
+  uint8_t cell;
+  uint8_t x;
+
+  if (!HD44780_DList_CanModel(State))
+  {
+    HD44780_DList_Keep(State, Code, Width);
+    HD44780_DList_Forget(State);
+    HD44780_DList_LoseCursor(State);
+    return;
+  }
+
+  // Pending writes under the field are overwritten by it
+  cell = State->Y * State->Length + State->X;
+  for (x = State->X; x < State->Length && x < State->X + Width; x++, cell++)
+    State->Flags[cell] = 0;
+
+  HD44780_DList_Keep(State, Code, Width);
+
+  if (State->X + Width > State->Length)
+  {
+    HD44780_DList_LoseCursor(State);
+  }
+  else
+  {
+    State->X += Width;
+    State->OutX = State->X;
+  }
+}
+
+static void
+HD44780_DList_Instruction(HD44780_DList_State_t *State, uint8_t Cmd)
+{
+  if ((Cmd & 0xF8) == HD44780_DISP_OFF)
+  {
+    // Display control
+    if (Cmd != State->Display)
+      HD44780_DList_Keep(State, HD44780_DLIST_CMD, Cmd);
+    State->Display = Cmd;
+  }
+  else if ((Cmd & 0xFC) == HD44780_ENTRY_DEC)
+  {
+    // Entry mode set
+    if (Cmd != State->Entry)
+      HD44780_DList_Keep(State, HD44780_DLIST_CMD, Cmd);
+    State->Entry = Cmd;
+  }
+  else
+  {
+    HD44780_DList_Keep(State, HD44780_DLIST_CMD, Cmd);
+
+    // Cursor shift, CGRAM and DDRAM address set move the cursor
+    if ((Cmd & 0xF8) == HD44780_MOVE_CURSOR_LEFT || Cmd >= 0x40)
+      HD44780_DList_LoseCursor(State);
+  }
+}
+
+static void
+HD44780_DList_ClearCells(HD44780_DList_State_t *State)
+{
+  HD44780_DList_t *dst = State->Dst;
+  uint8_t cell;
+
+  // Writes before clear are lost anyway
+  for (cell = 0; cell < State->Lines * State->Length; cell++)
+  {
+    State->Flags[cell] = HD44780_CELL_KNOWN;
+    State->Value[cell] = ' ';
+  }
+
+  if (dst->Count == 0 || dst->Entries[dst->Count - 1].Code != HD44780_DLIST_CLEAR)
+    HD44780_DList_Emit(State, HD44780_DLIST_CLEAR, 0);
+
+  State->X = State->Y = State->OutX = State->OutY = 0;
+  State->Entry |= 0x02;  // clear display sets increment mode
+}
+
+
+// Return time of updating one line of a region, and write the operations to
+// Dst if it is not NULL. Cleared: 1 if the line is cleared before (Old is not
+// used). Old: NULL if it is not known.
+static uint32_t
+HD44780_DList_PlanLine(HD44780_DList_t *Dst, const HD44780_Cost_t *Cost,
+                       const char *Old, const char *New, uint8_t Cleared,
+                       uint8_t X, uint8_t Y, uint8_t Width, uint8_t *Full)
+{
+  uint32_t time = 0;
+  uint8_t cursor = HD44780_DLIST_UNKNOWN;
+  uint8_t x;
+
+  for (x = 0; x < Width; x++)
+  {
+    if (Cleared ? (New[x] == ' ') : (Old && Old[x] == New[x]))
+      continue;
+
+    if (cursor != HD44780_DLIST_UNKNOWN &&
+        (uint32_t)(x - cursor) * Cost->DataUs < Cost->CommandUs)
+    {
+      // Bridge the gap
+      time += (uint32_t)(x - cursor) * Cost->DataUs;
+      for (; Dst && cursor < x; cursor++)
+        if (HD44780_DList_Putc(Dst, New[cursor]) != HD44780_OK)
+          *Full = 1;
+    }
+    else
+    {
+      time += Cost->CommandUs;
+      if (Dst && HD44780_DList_GoToXY(Dst, X + x, Y) != HD44780_OK)
+        *Full = 1;
+    }
+
+    time += Cost->DataUs;
+    if (Dst && HD44780_DList_Putc(Dst, New[x]) != HD44780_OK)
+      *Full = 1;
+    cursor = x + 1;
+  }
+
+  return time;
+}
+
+static uint32_t
+HD44780_DList_PlanRegion(HD44780_DList_t *Dst, const HD44780_Cost_t *Cost,
+                         const char *Old, const char *New,
+                         uint8_t X, uint8_t Y, uint8_t Width, uint8_t Height,
+                         uint8_t Clear, uint8_t *Full)
+{
+  uint32_t time = 0;
+  uint8_t row;
+
+  if (Clear)
+  {
+    time += Cost->ClearUs;
+    if (Dst && HD44780_DList_Clear(Dst) != HD44780_OK)
+      *Full = 1;
+  }
+
+  for (row = 0; row < Height; row++)
+  {
+    time += HD44780_DList_PlanLine(Dst, Cost, Old, New, Clear,
+                                   X, Y + row, Width, Full);
+    if (Old)
+      Old += Width;
+    New += Width;
+  }
+
+  return time;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize an empty display list
+ * @param  List: Pointer to display list
+ * @param  Entries: Array of Size operations
+ * @param  Size: Number of operations that fit in Entries
+ * @retval None
+ */
+void
+HD44780_DList_Init(HD44780_DList_t *List,
+                   HD44780_DListEntry_t *Entries, uint16_t Size)
+{
+  List->Entries = Entries;
+  List->Size = Size;
+  List->Count = 0;
+}
+
+/**
+ * @brief  Remove all operations of the list
+ * @param  List: Pointer to display list
+ * @retval None
+ */
+void
+HD44780_DList_Reset(HD44780_DList_t *List)
+{
+  List->Count = 0;
+}
+
+/**
+ * @brief  Record a cursor move (see HD44780_GoToXY())
+ * @param  List: Pointer to display list
+ * @param  X: Column
+ * @param  Y: Line
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: List is full.
+ */
+HD44780_Result_t
+HD44780_DList_GoToXY(HD44780_DList_t *List, uint8_t X, uint8_t Y)
+{
+  return HD44780_DList_Append(List, HD44780_DLIST_POS, (Y << 6) | (X & 0x3F));
+}
+
+/**
+ * @brief  Record writing a character at the cursor
+ * @note   Characters are written as they are ('\n' is not interpreted).
+ * @param  List: Pointer to display list
+ * @param  C: Character
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: List is full.
+ */
+HD44780_Result_t
+HD44780_DList_Putc(HD44780_DList_t *List, char C)
+{
+  return HD44780_DList_Append(List, HD44780_DLIST_DATA, C);
+}
+
+/**
+ * @brief  Record writing a string at the cursor
+ * @note   Characters are written as they are ('\n' is not interpreted).
+ * @param  List: Pointer to display list
+ * @param  Str: String to write
+ * @param  Len: Length of string. If 0, string will be written until null
+ *              character.
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: List is full (the string is partially recorded).
+ */
+HD44780_Result_t
+HD44780_DList_Puts(HD44780_DList_t *List, const char *Str, uint8_t Len)
+{
+  while (*Str)
+  {
+    if (HD44780_DList_Append(List, HD44780_DLIST_DATA, *Str++) != HD44780_OK)
+      return HD44780_FAIL;
+    if (Len && --Len == 0)
+      break;
+  }
+
+  return HD44780_OK;
+}
+
+/**
+ * @brief  Record a variable field of fixed width at the cursor
+ * @note   The text is taken from Vars[Index] of HD44780_DList_Play(), padded
+ *         with spaces or truncated to Width characters. This way a list can be
+ *         optimized once and played with different values.
+ * @param  List: Pointer to display list
+ * @param  Index: Index of the variable (0 to 15)
+ * @param  Width: Number of characters of the field (1 to 40)
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: List is full or invalid parameters.
+ */
+HD44780_Result_t
+HD44780_DList_PutVar(HD44780_DList_t *List, uint8_t Index, uint8_t Width)
+{
+  if (Index > 15 || Width == 0 || Width > 40)
+    return HD44780_FAIL;
+
+  return HD44780_DList_Append(List, HD44780_DLIST_VAR + Index, Width);
+}
+
+/**
+ * @brief  Record an instruction (see HD44780_Command())
+ * @note   Clear display and return home are recorded as HD44780_DList_Clear()
+ *         and HD44780_DList_Home().
+ * @param  List: Pointer to display list
+ * @param  Cmd: Instruction
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: List is full.
+ */
+HD44780_Result_t
+HD44780_DList_Command(HD44780_DList_t *List, uint8_t Cmd)
+{
+  if (Cmd == 0x01)
+    return HD44780_DList_Clear(List);
+
+  if ((Cmd & 0xFE) == 0x02)
+    return HD44780_DList_Home(List);
+
+  return HD44780_DList_Append(List, HD44780_DLIST_CMD, Cmd);
+}
+
+/**
+ * @brief  Record clearing the screen (see HD44780_ClearScreen())
+ * @param  List: Pointer to display list
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: List is full.
+ */
+HD44780_Result_t
+HD44780_DList_Clear(HD44780_DList_t *List)
+{
+  return HD44780_DList_Append(List, HD44780_DLIST_CLEAR, 0);
+}
+
+/**
+ * @brief  Record moving the cursor home (see HD44780_Home())
+ * @param  List: Pointer to display list
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: List is full.
+ */
+HD44780_Result_t
+HD44780_DList_Home(HD44780_DList_t *List)
+{
+  return HD44780_DList_Append(List, HD44780_DLIST_HOME, 0);
+}
+
+/**
+ * @brief  Write an optimized copy of a list
+ * @note   The result leaves the same screen content, cursor position and
+ *         display settings as Src:
+ *         - Cursor moves are only issued before a write that needs them.
+ *         - Writes of a cell that is overwritten later (or cleared) are
+ *           removed, as well as writes of the value a cell already has
+ *           because of an earlier write of the list.
+ *         - The remaining writes between two other operations are sorted into
+ *           runs of adjacent cells that need a single cursor move.
+ *         - Display control and entry mode instructions that do not change
+ *           the setting are removed.
+ *         Content of the screen before the list is played is not known, so
+ *         the first write of each cell is always kept. The list is assumed to
+ *         start in the default entry mode (increment, no shift). Writes after
+ *         other instructions that move the cursor are kept as they are.
+ * @param  Dst: Pointer to display list that receives the result
+ * @param  Src: Pointer to recorded display list
+ * @param  Lines: Number of lines of the display
+ * @param  Length: Number of characters in a line
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Dst is too small, the display is larger than
+ *                         HD44780_DLIST_CELLS or Src has an unknown operation.
+ */
+HD44780_Result_t
+HD44780_DList_Optimize(HD44780_DList_t *Dst, const HD44780_DList_t *Src,
+                       uint8_t Lines, uint8_t Length)
+{
+  HD44780_DList_State_t state;
+  const HD44780_DListEntry_t *entry;
+  uint16_t i;
+  uint8_t x, y;
+
+  if ((uint16_t)Lines * Length > HD44780_DLIST_CELLS || Dst == Src)
+    return HD44780_FAIL;
+
+  memset(&state, 0, sizeof(state));
+  state.Dst = Dst;
+  state.Lines = Lines;
+  state.Length = Length;
+  state.Entry = HD44780_ENTRY_INC_;
+  HD44780_DList_LoseCursor(&state);
+  Dst->Count = 0;
+
+  for (i = 0, entry = Src->Entries; i < Src->Count; i++, entry++)
+  {
+    switch (entry->Code)
+    {
+    case HD44780_DLIST_POS:
+      x = entry->Arg & 0x3F;
+      y = entry->Arg >> 6;
+      if (x <= Length && y < Lines)
+      {
+        // Issued later, only if a write needs it
+        state.X = x;
+        state.Y = y;
+      }
+      else
+      {
+        HD44780_DList_Keep(&state, HD44780_DLIST_POS, entry->Arg);
+        HD44780_DList_LoseCursor(&state);
+      }
+      break;
+
+    case HD44780_DLIST_DATA:
+      HD44780_DList_Write(&state, entry->Arg);
+      break;
+
+    case HD44780_DLIST_CMD:
+      HD44780_DList_Instruction(&state, entry->Arg);
+      break;
+
+    case HD44780_DLIST_CLEAR:
+      HD44780_DList_ClearCells(&state);
+      break;
+
+    case HD44780_DLIST_HOME:
+      HD44780_DList_Flush(&state, 0);
+      HD44780_DList_Emit(&state, HD44780_DLIST_HOME, 0);
+      state.X = state.Y = state.OutX = state.OutY = 0;
+      break;
+
+    default:
+      if (entry->Code < HD44780_DLIST_VAR)
+        return HD44780_FAIL;
+      HD44780_DList_Var(&state, entry->Code, entry->Arg);
+      break;
+    }
+  }
+
+  HD44780_DList_Flush(&state, 1);
+
+  return state.Full ? HD44780_FAIL : HD44780_OK;
+}
+
+/**
+ * @brief  Plan the cheapest update of a region from its old to its new content
+ * @note   Only changed cells are written. In each line, a gap of unchanged
+ *         cells between two changes is either skipped with a cursor move or
+ *         bridged by writing its characters again, whichever is cheaper. If
+ *         MayClear is 1, clearing the display and writing the non-space
+ *         characters is used instead when it is cheaper. The cursor position
+ *         after the plan is not defined.
+ * @param  Dst: Pointer to display list that receives the plan
+ * @param  Cost: Pointer to cost model (see HD44780_GetCost())
+ * @param  Old: Current content of the region (Width * Height characters, line
+ *              after line), or NULL if it is not known.
+ * @param  New: New content of the region
+ * @param  X: Column of top left corner of the region
+ * @param  Y: Line of top left corner of the region
+ * @param  Width: Width of the region
+ * @param  Height: Height of the region
+ * @param  MayClear: 1 if the region is the whole screen and clearing the
+ *                   display is allowed
+ * @param  TimeUs: Receives the estimated time of the plan. Can be NULL.
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Dst is too small.
+ */
+HD44780_Result_t
+HD44780_DList_Plan(HD44780_DList_t *Dst, const HD44780_Cost_t *Cost,
+                   const char *Old, const char *New,
+                   uint8_t X, uint8_t Y, uint8_t Width, uint8_t Height,
+                   uint8_t MayClear, uint32_t *TimeUs)
+{
+  uint8_t full = 0;
+  uint8_t clear = 0;
+  uint32_t time;
+
+  time = HD44780_DList_PlanRegion(NULL, Cost, Old, New,
+                                  X, Y, Width, Height, 0, &full);
+  if (MayClear &&
+      HD44780_DList_PlanRegion(NULL, Cost, Old, New,
+                               X, Y, Width, Height, 1, &full) < time)
+    clear = 1;
+
+  Dst->Count = 0;
+  time = HD44780_DList_PlanRegion(Dst, Cost, Old, New,
+                                  X, Y, Width, Height, clear, &full);
+  if (TimeUs)
+    *TimeUs = time;
+
+  return full ? HD44780_FAIL : HD44780_OK;
+}
+
+/**
+ * @brief  Play a display list on a handler
+ * @param  List: Pointer to display list
+ * @param  Handler: Pointer to initialized handler
+ * @param  Vars: Texts of variable fields (see HD44780_DList_PutVar()). Can be
+ *               NULL if the list has no variable fields.
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data, or the list has an
+ *                         unknown operation (skipped).
+ */
+HD44780_Result_t
+HD44780_DList_Play(const HD44780_DList_t *List, HD44780_Handler_t *Handler,
+                   const HD44780_Segment_t *Vars)
+{
+  static const HD44780_Segment_t empty = {"", 0};
+  const HD44780_DListEntry_t *entry;
+  HD44780_Result_t result = HD44780_OK;
+  HD44780_Result_t r;
+  uint16_t i;
+
+  for (i = 0, entry = List->Entries; i < List->Count; i++, entry++)
+  {
+    switch (entry->Code)
+    {
+    case HD44780_DLIST_POS:
+      r = HD44780_GoToXY(Handler, entry->Arg & 0x3F, entry->Arg >> 6);
+      break;
+
+    case HD44780_DLIST_DATA:
+      r = HD44780_Data(Handler, entry->Arg);
+      break;
+
+    case HD44780_DLIST_CMD:
+      r = HD44780_Command(Handler, entry->Arg);
+      break;
+
+    case HD44780_DLIST_CLEAR:
+      r = HD44780_ClearScreen(Handler);
+      break;
+
+    case HD44780_DLIST_HOME:
+      r = HD44780_Home(Handler);
+      break;
+
+    default:
+      if (entry->Code < HD44780_DLIST_VAR)
+      {
+        r = HD44780_FAIL;
+        break;
+      }
+      r = HD44780_Putv(Handler,
+                       Vars ? &Vars[entry->Code - HD44780_DLIST_VAR] : &empty,
+                       1, 0, HD44780_CURRENT_POS, entry->Arg);
+      break;
+    }
+
+    if (r != HD44780_OK)
+      result = HD44780_FAIL;
+  }
+
+  return result;
+}
@@ -0,0 +1,223 @@
+/**
+ **********************************************************************************
+ * @file   HD44780_layout.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Region based screen layout with per-region refresh rates
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "HD44780_layout.h"
+#include <stdio.h>
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static HD44780_Result_t
+HD44780_Region_Flush(HD44780_Region_t *Region, HD44780_Handler_t *Handler)
+{
+  HD44780_Result_t result = HD44780_OK;
+  const char *p = Region->Buffer;
+  uint8_t row;
+  uint8_t col;
+
+  for (row = 0; row < Region->Height; row++)
+  {
+    if (HD44780_GoToXY(Handler, Region->X, Region->Y + row) != HD44780_OK)
+      result = HD44780_FAIL;
+    for (col = 0; col < Region->Width; col++)
+    {
+      if (HD44780_Data(Handler, *p++) != HD44780_OK)
+        result = HD44780_FAIL;
+    }
+  }
+
+  // A region that failed is written again in the next update
+  if (result == HD44780_OK)
+    Region->Dirty = 0;
+
+  return result;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize a region and fill it with spaces
+ * @param  Region: Pointer to region
+ * @param  X: X position of top left corner
+ * @param  Y: Y position of top left corner
+ * @param  Width: Width in characters
+ * @param  Height: Height in lines
+ * @param  IntervalMs: Minimum time between two refreshes in milliseconds. If 0,
+ *                     the region is refreshed on change.
+ * @param  Buffer: Pointer to Width * Height characters
+ * @retval None
+ */
+void
+HD44780_Region_Init(HD44780_Region_t *Region,
+                    uint8_t X, uint8_t Y, uint8_t Width, uint8_t Height,
+                    uint16_t IntervalMs, char *Buffer)
+{
+  Region->X = X;
+  Region->Y = Y;
+  Region->Width = Width;
+  Region->Height = Height;
+  Region->IntervalMs = IntervalMs;
+  Region->LastUpdate = (uint32_t)0 - IntervalMs; // due at time 0
+  Region->Buffer = Buffer;
+  HD44780_Region_Clear(Region);
+}
+
+/**
+ * @brief  Render text into the region
+ * @note   Text is clipped at the end of the line. The region is marked dirty
+ *         only if its content changes.
+ * @param  Region: Pointer to region
+ * @param  Col: Column inside region
+ * @param  Row: Row inside region
+ * @param  Str: String to render
+ * @param  Len: Length of string. If 0, string will be rendered until null
+ *              character.
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Position is outside of region.
+ */
+HD44780_Result_t
+HD44780_Region_Puts(HD44780_Region_t *Region, uint8_t Col, uint8_t Row,
+                    const char *Str, uint8_t Len)
+{
+  char *p;
+  uint8_t n = 0;
+
+  if (Col >= Region->Width || Row >= Region->Height)
+    return HD44780_FAIL;
+
+  p = Region->Buffer + (uint16_t)Row * Region->Width + Col;
+  while ((Len == 0 || n < Len) && Str[n] && Col + n < Region->Width)
+  {
+    if (p[n] != Str[n])
+    {
+      p[n] = Str[n];
+      Region->Dirty = 1;
+    }
+    n++;
+  }
+
+  return HD44780_OK;
+}
+
+/**
+ * @brief  Fill the region with spaces
+ * @param  Region: Pointer to region
+ * @retval None
+ */
+void
+HD44780_Region_Clear(HD44780_Region_t *Region)
+{
+  uint16_t size = (uint16_t)Region->Width * Region->Height;
+  uint16_t i;
+
+  for (i = 0; i < size; i++)
+    Region->Buffer[i] = ' ';
+
+  Region->Dirty = 1;
+}
+
+/**
+ * @brief  Initialize the layout
+ * @param  Layout: Pointer to layout
+ * @param  Handler: Pointer to initialized handler
+ * @param  Regions: Array of initialized regions
+ * @param  Count: Number of regions
+ * @param  CellBudget: Maximum characters written per update. If 0, all due
+ *                     regions are written in each update.
+ * @retval None
+ */
+void
+HD44780_Layout_Init(HD44780_Layout_t *Layout, HD44780_Handler_t *Handler,
+                    HD44780_Region_t *Regions, uint8_t Count,
+                    uint16_t CellBudget)
+{
+  Layout->Handler = Handler;
+  Layout->Regions = Regions;
+  Layout->Count = Count;
+  Layout->Next = 0;
+  Layout->CellBudget = CellBudget;
+}
+
+/**
+ * @brief  Write regions that are both dirty and due to the display
+ * @note   Regions are checked round robin starting after the last written one,
+ *         so a fast changing region can not starve the others. A region is
+ *         always written completely, even if it exceeds the remaining budget.
+ *         A region that could not be written stays dirty.
+ * @param  Layout: Pointer to layout
+ * @param  NowMs: Current time in milliseconds
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_Layout_Update(HD44780_Layout_t *Layout, uint32_t NowMs)
+{
+  HD44780_Result_t result = HD44780_OK;
+  HD44780_Region_t *region;
+  uint16_t written = 0;
+  uint8_t index = Layout->Next;
+  uint8_t i;
+
+  for (i = 0; i < Layout->Count; i++)
+  {
+    if (Layout->CellBudget && written >= Layout->CellBudget)
+      break;
+
+    region = &Layout->Regions[index];
+    if (++index >= Layout->Count)
+      index = 0;
+
+    if (!region->Dirty ||
+        (uint32_t)(NowMs - region->LastUpdate) < region->IntervalMs)
+      continue;
+
+    if (HD44780_Region_Flush(region, Layout->Handler) != HD44780_OK)
+      result = HD44780_FAIL;
+    written += (uint16_t)region->Width * region->Height;
+    region->LastUpdate = NowMs;
+    Layout->Next = index;
+  }
+
+  return result;
+}
@@ -0,0 +1,578 @@
+/**
+ **********************************************************************************
+ * @file   HD44780_queue.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Lock-free multi-producer submission queue for HD44780 driver
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "HD44780_queue.h"
+#include <stdio.h>
+#if !HD44780_QUEUE_ATOMIC && defined(__AVR__)
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#endif
+
+
+
+/* Private Constants ------------------------------------------------------------*/
+#if (HD44780_QUEUE_SIZE & (HD44780_QUEUE_SIZE - 1)) != 0
+#error "HD44780_QUEUE_SIZE must be a power of two"
+#endif
+
+#if (HD44780_QUEUE_URGENT_SIZE & (HD44780_QUEUE_URGENT_SIZE - 1)) != 0
+#error "HD44780_QUEUE_URGENT_SIZE must be a power of two"
+#endif
+
+
+/* Private Macro ----------------------------------------------------------------*/
+#if !HD44780_QUEUE_ATOMIC
+#if defined(__AVR__) && !defined(HD44780_QUEUE_ENTER_CRITICAL)
+#define HD44780_QUEUE_ENTER_CRITICAL()  uint8_t sreg = SREG; cli()
+#define HD44780_QUEUE_EXIT_CRITICAL()   SREG = sreg
+#endif
+
+#if !defined(HD44780_QUEUE_ENTER_CRITICAL) || !defined(HD44780_QUEUE_EXIT_CRITICAL)
+#error "Define HD44780_QUEUE_ENTER_CRITICAL() and HD44780_QUEUE_EXIT_CRITICAL()"
+#endif
+#endif
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+#if HD44780_QUEUE_ATOMIC
+
+static inline unsigned int
+HD44780_Queue_Load(HD44780_QueueSeq_t *Seq)
+{
+  return atomic_load_explicit(Seq, memory_order_acquire);
+}
+
+static inline void
+HD44780_Queue_Store(HD44780_QueueSeq_t *Seq, unsigned int Value)
+{
+  atomic_store_explicit(Seq, Value, memory_order_release);
+}
+
+static inline uint8_t
+HD44780_Queue_Claim(HD44780_QueueSeq_t *Seq, unsigned int *Expected)
+{
+  return atomic_compare_exchange_weak_explicit(Seq, Expected, *Expected + 1,
+                                               memory_order_relaxed,
+                                               memory_order_relaxed);
+}
+
+#else
+
+static inline unsigned int
+HD44780_Queue_Load(HD44780_QueueSeq_t *Seq)
+{
+  unsigned int value;
+
+  HD44780_QUEUE_ENTER_CRITICAL();
+  value = *Seq;
+  HD44780_QUEUE_EXIT_CRITICAL();
+
+  return value;
+}
+
+static inline void
+HD44780_Queue_Store(HD44780_QueueSeq_t *Seq, unsigned int Value)
+{
+  HD44780_QUEUE_ENTER_CRITICAL();
+  *Seq = Value;
+  HD44780_QUEUE_EXIT_CRITICAL();
+}
+
+static inline uint8_t
+HD44780_Queue_Claim(HD44780_QueueSeq_t *Seq, unsigned int *Expected)
+{
+  uint8_t claimed = 0;
+
+  HD44780_QUEUE_ENTER_CRITICAL();
+  if (*Seq == *Expected)
+  {
+    *Seq = *Expected + 1;
+    claimed = 1;
+  }
+  else
+  {
+    *Expected = *Seq;
+  }
+  HD44780_QUEUE_EXIT_CRITICAL();
+
+  return claimed;
+}
+
+#endif
+
+static HD44780_Result_t
+HD44780_Queue_Post(HD44780_QueueLane_t *Lane, uint8_t X, uint8_t Y,
+                   const char *Str, uint8_t Len, uint8_t Priority)
+{
+  HD44780_QueueEntry_t *entry;
+  unsigned int pos;
+  unsigned int seq;
+  int diff;
+  uint8_t i;
+
+  pos = HD44780_Queue_Load(&Lane->Head);
+  for (;;)
+  {
+    entry = &Lane->Entries[pos & Lane->Mask];
+    seq = HD44780_Queue_Load(&entry->Sequence);
+    diff = (int)(seq - pos);
+
+    if (diff == 0)
+    {
+      // Entry is free, try to claim it (fails if another producer was faster)
+      if (HD44780_Queue_Claim(&Lane->Head, &pos))
+        break;
+    }
+    else if (diff < 0)
+    {
+      // Entry is not processed yet, queue is full
+      return HD44780_FAIL;
+    }
+    else
+    {
+      pos = HD44780_Queue_Load(&Lane->Head);
+    }
+  }
+
+  entry->X = X;
+  entry->Y = Y;
+  entry->Len = Len;
+  entry->Priority = Priority;
+  for (i = 0; i < Len; i++)
+    entry->Text[i] = Str[i];
+
+  // Publish the entry to the consumer
+  HD44780_Queue_Store(&entry->Sequence, pos + 1);
+
+  return HD44780_OK;
+}
+
+
+static HD44780_Result_t
+HD44780_Queue_PostLane(HD44780_QueueLane_t *Lane, uint8_t X, uint8_t Y,
+                       const char *Str, uint8_t Len, uint8_t Priority)
+{
+  uint8_t len = 0;
+
+  // Stop at null character in both cases
+  while ((Len == 0 || len < Len) && Str[len])
+  {
+    if (len == HD44780_QUEUE_TEXT_MAX)
+      return HD44780_FAIL;
+    len++;
+  }
+
+  return HD44780_Queue_Post(Lane, X, Y, Str, len, Priority);
+}
+
+static HD44780_QueueEntry_t *
+HD44780_Queue_Peek(HD44780_QueueLane_t *Lane)
+{
+  HD44780_QueueEntry_t *entry;
+  unsigned int pos = Lane->Tail;
+
+  entry = &Lane->Entries[pos & Lane->Mask];
+
+  // Entry is not claimed, or claimed but the producer has not finished it yet
+  if (HD44780_Queue_Load(&entry->Sequence) != pos + 1)
+    return NULL;
+
+  return entry;
+}
+
+static void
+HD44780_Queue_Release(HD44780_QueueLane_t *Lane, HD44780_QueueEntry_t *Entry)
+{
+  unsigned int pos = Lane->Tail;
+
+  HD44780_Queue_Store(&Entry->Sequence, pos + Lane->Mask + 1);
+  Lane->Tail = pos + 1;
+}
+
+// Driver calls of the consumer, a failure is reported by the process call
+static void
+HD44780_Queue_GoToXY(HD44780_Queue_t *Queue, uint8_t X, uint8_t Y)
+{
+  if (HD44780_GoToXY(Queue->Handler, X, Y) != HD44780_OK)
+    Queue->Result = HD44780_FAIL;
+}
+
+static void
+HD44780_Queue_Data(HD44780_Queue_t *Queue, char C)
+{
+  if (HD44780_Data(Queue->Handler, C) != HD44780_OK)
+    Queue->Result = HD44780_FAIL;
+}
+
+static uint8_t
+HD44780_Queue_Preempt(HD44780_Queue_t *Queue)
+{
+  HD44780_Handler_t *handler = Queue->Handler;
+  HD44780_QueueEntry_t *entry;
+  uint16_t index;
+  uint8_t written = 0;
+  uint8_t i;
+
+  while ((entry = HD44780_Queue_Peek(&Queue->Urgent)) != NULL)
+  {
+    HD44780_Queue_GoToXY(Queue, entry->X, entry->Y);
+    for (i = 0; i < entry->Len; i++)
+      HD44780_Queue_Data(Queue, entry->Text[i]);
+
+    // Pending routine writes to these cells are older than the urgent ones
+    if (Queue->Pending && entry->Y < handler->Lines)
+    {
+      index = (uint16_t)entry->Y * handler->Length + entry->X;
+      for (i = 0; i < entry->Len && entry->X + i < handler->Length; i++)
+        Queue->State[index + i] = 0;
+    }
+
+    HD44780_Queue_Release(&Queue->Urgent, entry);
+    written = 1;
+  }
+
+  return written;
+}
+
+static void
+HD44780_Queue_WriteEntry(HD44780_Queue_t *Queue, HD44780_QueueEntry_t *Entry)
+{
+  uint8_t i;
+
+  HD44780_Queue_GoToXY(Queue, Entry->X, Entry->Y);
+  for (i = 0; i < Entry->Len; i++)
+  {
+    // Restore cursor position of routine work after urgent writes
+    if (HD44780_Queue_Preempt(Queue))
+      HD44780_Queue_GoToXY(Queue, Entry->X + i, Entry->Y);
+
+    HD44780_Queue_Data(Queue, Entry->Text[i]);
+  }
+}
+
+static void
+HD44780_Queue_Coalesce(HD44780_Queue_t *Queue, HD44780_QueueEntry_t *Entry)
+{
+  HD44780_Handler_t *handler = Queue->Handler;
+  uint16_t index;
+  uint8_t state;
+  uint8_t i;
+
+  if (Entry->Y >= handler->Lines)
+    return;
+
+  index = (uint16_t)Entry->Y * handler->Length + Entry->X;
+  state = Entry->Priority + 1;
+  for (i = 0; i < Entry->Len && Entry->X + i < handler->Length; i++, index++)
+  {
+    Queue->Pending[index] = Entry->Text[i];
+
+    // Keep the highest priority of all pending writes to the cell
+    if (Queue->State[index] < state)
+      Queue->State[index] = state;
+  }
+}
+
+static void
+HD44780_Queue_Flush(HD44780_Queue_t *Queue)
+{
+  HD44780_Handler_t *handler = Queue->Handler;
+  uint16_t size;
+  uint16_t index;
+  uint16_t next = 0xFFFF; // index of the cell address counter points to
+  HD44780_Cost_t costs;
+  uint16_t cost;
+  uint16_t spent = 0;
+  uint8_t level;
+
+  size = (uint16_t)handler->Lines * handler->Length;
+
+  // Execution and transfer time of each write on this port
+  HD44780_GetCost(handler, &costs);
+
+  for (;;)
+  {
+    // Find the highest pending priority
+    level = 0;
+    for (index = 0; index < size; index++)
+    {
+      if (Queue->State[index] > level)
+        level = Queue->State[index];
+    }
+    if (level == 0)
+      return;
+
+    for (index = 0; index < size; index++)
+    {
+      if (HD44780_Queue_Preempt(Queue))
+        next = 0xFFFF;
+
+      if (Queue->State[index] != level)
+        continue;
+
+      cost = costs.DataUs;
+      if (index != next)
+        cost += costs.CommandUs;
+
+      // Always make progress, even if a single write exceeds the budget
+      if (Queue->BudgetUs && spent && (uint32_t)spent + cost > Queue->BudgetUs)
+        return;
+      spent += cost;
+
+      if (index != next)
+        HD44780_Queue_GoToXY(Queue, index % handler->Length,
+                             index / handler->Length);
+      HD44780_Queue_Data(Queue, Queue->Pending[index]);
+      Queue->State[index] = 0;
+
+      // Address counter does not continue to the next line
+      next = ((index + 1) % handler->Length) ? index + 1 : 0xFFFF;
+    }
+  }
+}
+
+static void
+HD44780_Queue_InitLane(HD44780_QueueLane_t *Lane,
+                       HD44780_QueueEntry_t *Entries, unsigned int Size)
+{
+  unsigned int i;
+
+  Lane->Entries = Entries;
+  Lane->Mask = Size - 1;
+  Lane->Tail = 0;
+  for (i = 0; i < Size; i++)
+    HD44780_Queue_Store(&Entries[i].Sequence, i);
+  HD44780_Queue_Store(&Lane->Head, 0);
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize the queue
+ * @param  Queue: Pointer to queue
+ * @param  Handler: Pointer to initialized handler the queue is drained to
+ * @retval None
+ */
+void
+HD44780_Queue_Init(HD44780_Queue_t *Queue, HD44780_Handler_t *Handler)
+{
+  Queue->Handler = Handler;
+  Queue->Pending = NULL;
+  Queue->State = NULL;
+  Queue->BudgetUs = 0;
+  Queue->Result = HD44780_OK;
+  HD44780_Queue_InitLane(&Queue->Routine, Queue->RoutineEntries,
+                         HD44780_QUEUE_SIZE);
+  HD44780_Queue_InitLane(&Queue->Urgent, Queue->UrgentEntries,
+                         HD44780_QUEUE_URGENT_SIZE);
+}
+
+/**
+ * @brief  Post a single character to be displayed at specified position
+ * @note   This function never blocks and can be called from any context
+ *         (including ISRs) at the same time.
+ * @param  Queue: Pointer to queue
+ * @param  X: X position
+ * @param  Y: Y position
+ * @param  C: Character to display
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Queue is full.
+ */
+HD44780_Result_t
+HD44780_Queue_PostChar(HD44780_Queue_t *Queue, uint8_t X, uint8_t Y, char C)
+{
+  return HD44780_Queue_Post(&Queue->Routine, X, Y, &C, 1, 0);
+}
+
+/**
+ * @brief  Post a short string to be displayed at specified position
+ * @note   This function never blocks and can be called from any context
+ *         (including ISRs) at the same time.
+ * @param  Queue: Pointer to queue
+ * @param  X: X position
+ * @param  Y: Y position
+ * @param  Str: String to display
+ * @param  Len: Length of string. If 0, string will be displayed until null
+ *              character.
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Queue is full or string is longer than
+ *                         HD44780_QUEUE_TEXT_MAX.
+ */
+HD44780_Result_t
+HD44780_Queue_PostString(HD44780_Queue_t *Queue, uint8_t X, uint8_t Y,
+                         const char *Str, uint8_t Len)
+{
+  return HD44780_Queue_PostPriority(Queue, X, Y, Str, Len, 0);
+}
+
+/**
+ * @brief  Post a short string with a priority
+ * @note   Priority only matters in coalescing mode: when the budget of a
+ *         process call is spent, the remaining characters are written in
+ *         later calls, higher priorities first.
+ * @param  Queue: Pointer to queue
+ * @param  X: X position
+ * @param  Y: Y position
+ * @param  Str: String to display
+ * @param  Len: Length of string. If 0, string will be displayed until null
+ *              character.
+ * @param  Priority: Priority of the update (0 is the lowest, max 254)
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Queue is full or string is longer than
+ *                         HD44780_QUEUE_TEXT_MAX.
+ */
+HD44780_Result_t
+HD44780_Queue_PostPriority(HD44780_Queue_t *Queue, uint8_t X, uint8_t Y,
+                           const char *Str, uint8_t Len, uint8_t Priority)
+{
+  if (Priority == 0xFF)
+    return HD44780_FAIL;
+
+  return HD44780_Queue_PostLane(&Queue->Routine, X, Y, Str, Len, Priority);
+}
+
+/**
+ * @brief  Post a short string to the urgent lane (e.g. an alarm message)
+ * @note   While HD44780_Queue_Process() is running, urgent entries are written
+ *         right after the byte currently being written, then routine work
+ *         resumes at its own cursor position. The worst-case latency is one
+ *         byte write plus the urgent entries posted before, or the period of
+ *         HD44780_Queue_Process() calls if it is not running. Urgent writes
+ *         are not limited by the budget of coalescing mode.
+ * @note   In coalescing mode, pending routine writes to the same cells are
+ *         dropped. Otherwise routine entries posted before may still
+ *         overwrite the urgent text.
+ * @param  Queue: Pointer to queue
+ * @param  X: X position
+ * @param  Y: Y position
+ * @param  Str: String to display
+ * @param  Len: Length of string. If 0, string will be displayed until null
+ *              character.
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Urgent lane is full or string is longer than
+ *                         HD44780_QUEUE_TEXT_MAX.
+ */
+HD44780_Result_t
+HD44780_Queue_PostUrgent(HD44780_Queue_t *Queue, uint8_t X, uint8_t Y,
+                         const char *Str, uint8_t Len)
+{
+  return HD44780_Queue_PostLane(&Queue->Urgent, X, Y, Str, Len, 0);
+}
+
+/**
+ * @brief  Enable coalescing mode
+ * @note   Repeated writes to the same cell overwrite each other before they
+ *         are written to the display. The bus time of each process call is
+ *         limited to BudgetUs, estimated with HD44780_GetCost() (execution
+ *         and transfer time of each write).
+ * @param  Queue: Pointer to queue
+ * @param  Pending: Buffer of Lines * Length characters
+ * @param  State: Buffer of Lines * Length bytes
+ * @param  BudgetUs: Bus time budget of each process call. If 0, all pending
+ *                   characters are written.
+ * @retval None
+ */
+void
+HD44780_Queue_SetCoalescing(HD44780_Queue_t *Queue,
+                            char *Pending, uint8_t *State, uint16_t BudgetUs)
+{
+  uint16_t size;
+  uint16_t i;
+
+  size = (uint16_t)Queue->Handler->Lines * Queue->Handler->Length;
+  for (i = 0; i < size; i++)
+    State[i] = 0;
+
+  Queue->Pending = Pending;
+  Queue->State = State;
+  Queue->BudgetUs = BudgetUs;
+}
+
+/**
+ * @brief  Write posted entries to the display
+ * @note   Only one context (the consumer) may call this function. Entries
+ *         posted while processing are left for the next call. In coalescing
+ *         mode, characters that do not fit in the budget are carried over.
+ * @param  Queue: Pointer to queue
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_Queue_Process(HD44780_Queue_t *Queue)
+{
+  HD44780_QueueEntry_t *entry;
+  unsigned int count;
+
+  Queue->Result = HD44780_OK;
+
+  // Entries posted while processing are left for the next call
+  count = HD44780_Queue_Load(&Queue->Routine.Head) - Queue->Routine.Tail;
+
+  for (; count; count--)
+  {
+    entry = HD44780_Queue_Peek(&Queue->Routine);
+    if (entry == NULL)
+      break;
+
+    if (Queue->Pending)
+      HD44780_Queue_Coalesce(Queue, entry);
+    else
+      HD44780_Queue_WriteEntry(Queue, entry);
+
+    HD44780_Queue_Release(&Queue->Routine, entry);
+  }
+
+  // Routine entries posted before the urgent ones are merged first, so
+  // urgent writes drop their older text
+  HD44780_Queue_Preempt(Queue);
+
+  if (Queue->Pending)
+    HD44780_Queue_Flush(Queue);
+
+  return Queue->Result;
+}
@@ -0,0 +1,213 @@
+/**
+ **********************************************************************************
+ * @file   HD44780_record.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Records public calls of HD44780 driver into a compact binary log
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "HD44780_record.h"
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static uint32_t
+HD44780_Record_Now(HD44780_Record_t *Record)
+{
+  if (Record->PlatformGetTimeUs)
+    return Record->PlatformGetTimeUs();
+
+  return 0;
+}
+
+static void
+HD44780_Record_Append(HD44780_Record_t *Record,
+                      const uint8_t *Args, uint8_t Size)
+{
+  uint8_t *size = &Record->Buffer[Record->Last];
+
+  if (Record->Skip)
+    return;
+
+  // Arguments of a call are limited to 255 bytes, a longer call keeps no
+  // arguments so it is not replayed with a malformed block
+  if (Size > 255 - *size)
+  {
+    Record->Count = Record->Last + 1;
+    *size = 0;
+    Record->Skip = 1;
+    Record->Dropped++;
+    return;
+  }
+
+  if (Record->Count + Size > HD44780_RECORD_SIZE)
+  {
+    // Keep the log consistent, the call is cut here
+    Size = HD44780_RECORD_SIZE - Record->Count;
+    Record->Skip = 1;
+    Record->Dropped++;
+  }
+
+  *size += Size;
+  while (Size--)
+    Record->Buffer[Record->Count++] = *Args++;
+}
+
+static void
+HD44780_Record_Call(void *Context, uint8_t Call, const uint8_t *Args, uint8_t Size)
+{
+  HD44780_Record_t *record = (HD44780_Record_t *)Context;
+  uint8_t head[1 + 5 + 1];  // call, time, size
+  uint8_t length = 0;
+  uint8_t i;
+  uint32_t now;
+  uint32_t delta;
+
+  if (Call & HD44780_CALL_MORE)
+  {
+    HD44780_Record_Append(record, Args, Size);
+    return;
+  }
+
+  now = HD44780_Record_Now(record);
+  delta = now - record->LastTime;
+
+  head[length++] = Call;
+  do
+  {
+    head[length] = delta & 0x7F;
+    delta >>= 7;
+    if (delta)
+      head[length] |= 0x80;
+    length++;
+  } while (delta);
+  head[length++] = 0;
+
+  if (record->Count + length > HD44780_RECORD_SIZE)
+  {
+    record->Skip = 1;
+    record->Dropped++;
+    return;
+  }
+
+  // The time of a dropped call is added to the next one
+  record->LastTime = now;
+  record->Skip = 0;
+  for (i = 0; i < length; i++)
+    record->Buffer[record->Count++] = head[i];
+  record->Last = record->Count - 1;
+
+  HD44780_Record_Append(record, Args, Size);
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Start recording public calls of the handler
+ * @note   Attach before HD44780_Init() to be able to replay the log. The log is
+ *         cleared. Requires HD44780_CONFIG_RECORD.
+ * @param  Record: Pointer to call recorder
+ * @param  Handler: Pointer to handler
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Handler is already recorded.
+ */
+HD44780_Result_t
+HD44780_Record_Attach(HD44780_Record_t *Record, HD44780_Handler_t *Handler)
+{
+  if (Handler->Record != NULL)
+    return HD44780_FAIL;
+
+  HD44780_Record_Clear(Record);
+  Handler->Record = HD44780_Record_Call;
+  Handler->RecordContext = Record;
+
+  return HD44780_OK;
+}
+
+/**
+ * @brief  Stop recording public calls of the handler
+ * @param  Record: Pointer to call recorder
+ * @param  Handler: Pointer to handler
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Recorder is not attached to this handler.
+ */
+HD44780_Result_t
+HD44780_Record_Detach(HD44780_Record_t *Record, HD44780_Handler_t *Handler)
+{
+  if (Handler->Record != HD44780_Record_Call ||
+      Handler->RecordContext != Record)
+    return HD44780_FAIL;
+
+  Handler->Record = NULL;
+  Handler->RecordContext = NULL;
+
+  return HD44780_OK;
+}
+
+/**
+ * @brief  Discard all recorded calls
+ * @param  Record: Pointer to call recorder
+ * @retval None
+ */
+void
+HD44780_Record_Clear(HD44780_Record_t *Record)
+{
+  Record->Buffer[0] = 'H';
+  Record->Buffer[1] = 'D';
+  Record->Buffer[2] = 'R';
+  Record->Buffer[3] = HD44780_RECORD_VERSION;
+  Record->Count = HD44780_RECORD_HEADER;
+  Record->Last = 0;
+  Record->Dropped = 0;
+  Record->Skip = 1;
+  Record->LastTime = HD44780_Record_Now(Record);
+}
+
+/**
+ * @brief  Output the log (e.g. to a file or a serial port)
+ * @param  Record: Pointer to call recorder
+ * @param  Write: Function to output a piece of the log
+ * @retval None
+ */
+void
+HD44780_Record_Dump(const HD44780_Record_t *Record,
+                    void (*Write)(const uint8_t *Data, uint16_t Size))
+{
+  Write(Record->Buffer, Record->Count);
+}
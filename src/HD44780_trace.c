@@ -0,0 +1,442 @@
+/**
+ **********************************************************************************
+ * @file   HD44780_trace.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Pin-level trace recorder for HD44780 driver with VCD export
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "HD44780_trace.h"
+#include <stdio.h>
+
+
+
+/* Private Variables ------------------------------------------------------------*/
+static const char * const SignalName[HD44780_TRACE_SIGNALS] =
+{
+  "RS", "RW", "E", "DATA", "DIR"
+};
+
+static const uint8_t SignalWidth[HD44780_TRACE_SIGNALS] =
+{
+  1, 1, 1, 4, 1
+};
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+#if !(HD44780_CONFIG_OPS_FLASH)
+static uint32_t
+HD44780_Trace_Now(HD44780_Trace_t *Trace)
+{
+  if (Trace->PlatformGetTimeNs)
+    return Trace->PlatformGetTimeNs();
+
+  return Trace->VirtualTime;
+}
+
+static void
+HD44780_Trace_Record(HD44780_Trace_t *Trace, uint8_t Signal, uint8_t Value)
+{
+  HD44780_TraceEvent_t *event;
+  uint16_t index;
+
+  index = Trace->Head + Trace->Count;
+  if (index >= HD44780_TRACE_SIZE)
+    index -= HD44780_TRACE_SIZE;
+
+  if (Trace->Count < HD44780_TRACE_SIZE)
+  {
+    Trace->Count++;
+  }
+  else
+  {
+    // Buffer is full, overwrite the oldest event
+    Trace->Head++;
+    if (Trace->Head >= HD44780_TRACE_SIZE)
+      Trace->Head = 0;
+  }
+
+  event = &Trace->Events[index];
+  event->Time = HD44780_Trace_Now(Trace);
+  event->Signal = Signal;
+  event->Value = Value;
+}
+
+static void
+TracedInitRsRwE(void *Context)
+{
+  HD44780_Trace_t *trace = (HD44780_Trace_t *)Context;
+
+  if (trace->Ops->PlatformInitRsRwE)
+    trace->Ops->PlatformInitRsRwE(trace->Context);
+}
+
+static void
+TracedSetValRs(void *Context, uint8_t Level)
+{
+  HD44780_Trace_t *trace = (HD44780_Trace_t *)Context;
+
+  trace->Ops->PlatformSetValRs(trace->Context, Level);
+  HD44780_Trace_Record(trace, HD44780_TRACE_RS, Level ? 1 : 0);
+}
+
+static void
+TracedSetValRw(void *Context, uint8_t Level)
+{
+  HD44780_Trace_t *trace = (HD44780_Trace_t *)Context;
+
+  trace->Ops->PlatformSetValRw(trace->Context, Level);
+  HD44780_Trace_Record(trace, HD44780_TRACE_RW, Level ? 1 : 0);
+}
+
+static void
+TracedSetValE(void *Context, uint8_t Level)
+{
+  HD44780_Trace_t *trace = (HD44780_Trace_t *)Context;
+
+  trace->Ops->PlatformSetValE(trace->Context, Level);
+  HD44780_Trace_Record(trace, HD44780_TRACE_E, Level ? 1 : 0);
+}
+
+static void
+TracedSetDirData(void *Context, uint8_t Dir)
+{
+  HD44780_Trace_t *trace = (HD44780_Trace_t *)Context;
+
+  trace->Ops->PlatformSetDirData(trace->Context, Dir);
+  HD44780_Trace_Record(trace, HD44780_TRACE_DIR, Dir ? 1 : 0);
+}
+
+static void
+TracedWriteData(void *Context, uint8_t Data)
+{
+  HD44780_Trace_t *trace = (HD44780_Trace_t *)Context;
+
+  trace->Ops->PlatformWriteData(trace->Context, Data);
+  HD44780_Trace_Record(trace, HD44780_TRACE_DATA, Data >> 4);
+}
+
+static uint8_t
+TracedReadData(void *Context)
+{
+  HD44780_Trace_t *trace = (HD44780_Trace_t *)Context;
+  uint8_t data;
+
+  data = trace->Ops->PlatformReadData(trace->Context);
+  HD44780_Trace_Record(trace, HD44780_TRACE_DATA, data >> 4);
+
+  return data;
+}
+
+static void
+TracedDelayMs(void *Context, uint16_t Delay)
+{
+  HD44780_Trace_t *trace = (HD44780_Trace_t *)Context;
+
+  trace->Ops->PlatformDelayMs(trace->Context, Delay);
+  trace->VirtualTime += (uint32_t)Delay * 1000000;
+}
+
+static void
+TracedDelayUs(void *Context, uint16_t Delay)
+{
+  HD44780_Trace_t *trace = (HD44780_Trace_t *)Context;
+
+  trace->Ops->PlatformDelayUs(trace->Context, Delay);
+  trace->VirtualTime += (uint32_t)Delay * 1000;
+}
+
+static void
+TracedFlush(void *Context)
+{
+  HD44780_Trace_t *trace = (HD44780_Trace_t *)Context;
+
+  if (trace->Ops->PlatformFlush)
+    trace->Ops->PlatformFlush(trace->Context);
+}
+
+static uint32_t
+TracedGetTimeUs(void *Context)
+{
+  HD44780_Trace_t *trace = (HD44780_Trace_t *)Context;
+
+  return trace->Ops->PlatformGetTimeUs(trace->Context);
+}
+
+#endif
+
+static char *
+HD44780_Trace_UIntToStr(uint64_t Value, char *Buf)
+{
+  char *p = Buf + 20;
+
+  *p = '\0';
+  do
+  {
+    *--p = '0' + (Value % 10);
+    Value /= 10;
+  } while (Value);
+
+  return p;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+#if !(HD44780_CONFIG_OPS_FLASH)
+/**
+ * @brief  Wrap platform functions of the handler with the trace recorder
+ * @note   Handler must be initialized by the platform before calling this
+ *         function. Each traced handler needs its own trace recorder.
+ * @note   Not available if HD44780_CONFIG_OPS_FLASH is 1, because the wrapper
+ *         table is built in RAM.
+ * @param  Trace: Pointer to trace recorder
+ * @param  Handler: Pointer to handler
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Handler has no platform or is already traced.
+ */
+HD44780_Result_t
+HD44780_Trace_Attach(HD44780_Trace_t *Trace, HD44780_Handler_t *Handler)
+{
+  const HD44780_Ops_t *ops = Handler->Ops;
+  HD44780_Ops_t *wrapper = &Trace->Wrapper;
+
+  if (ops == NULL || ops->PlatformSetValE == TracedSetValE)
+    return HD44780_FAIL;
+
+  Trace->Ops = ops;
+  Trace->Context = Handler->Context;
+  Trace->VirtualTime = 0;
+  HD44780_Trace_Clear(Trace);
+
+  // Optional functions stay optional
+  wrapper->PlatformInitRsRwE = TracedInitRsRwE;
+  wrapper->PlatformSetValRs = TracedSetValRs;
+  wrapper->PlatformSetValRw = TracedSetValRw;
+  wrapper->PlatformSetValE = TracedSetValE;
+  wrapper->PlatformSetDirData = TracedSetDirData;
+  wrapper->PlatformWriteData = TracedWriteData;
+  wrapper->PlatformReadData = ops->PlatformReadData ? TracedReadData : NULL;
+  wrapper->PlatformDelayMs = TracedDelayMs;
+  wrapper->PlatformDelayUs = TracedDelayUs;
+  wrapper->PlatformFlush = ops->PlatformFlush ? TracedFlush : NULL;
+  wrapper->PlatformGetTimeUs = ops->PlatformGetTimeUs ? TracedGetTimeUs : NULL;
+
+  Handler->Ops = wrapper;
+  Handler->Context = Trace;
+
+  return HD44780_OK;
+}
+
+/**
+ * @brief  Restore original platform functions of the handler
+ * @param  Trace: Pointer to trace recorder
+ * @param  Handler: Pointer to handler
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Trace is not attached to this handler.
+ */
+HD44780_Result_t
+HD44780_Trace_Detach(HD44780_Trace_t *Trace, HD44780_Handler_t *Handler)
+{
+  if (Handler->Context != Trace || Handler->Ops != &Trace->Wrapper)
+    return HD44780_FAIL;
+
+  Handler->Ops = Trace->Ops;
+  Handler->Context = Trace->Context;
+
+  return HD44780_OK;
+}
+
+#endif
+
+/**
+ * @brief  Discard all recorded events
+ * @param  Trace: Pointer to trace recorder
+ * @retval None
+ */
+void
+HD44780_Trace_Clear(HD44780_Trace_t *Trace)
+{
+  Trace->Head = 0;
+  Trace->Count = 0;
+}
+
+/**
+ * @brief  Get a recorded event
+ * @param  Trace: Pointer to trace recorder
+ * @param  Index: Event index. 0 is the oldest event in the buffer.
+ * @retval Pointer to event or NULL if Index is out of range
+ */
+const HD44780_TraceEvent_t *
+HD44780_Trace_GetEvent(const HD44780_Trace_t *Trace, uint16_t Index)
+{
+  uint16_t index;
+
+  if (Index >= Trace->Count)
+    return NULL;
+
+  index = Trace->Head + Index;
+  if (index >= HD44780_TRACE_SIZE)
+    index -= HD44780_TRACE_SIZE;
+
+  return &Trace->Events[index];
+}
+
+/**
+ * @brief  Find the shortest high pulse of a 1-bit signal in the buffer
+ * @param  Trace: Pointer to trace recorder
+ * @param  Signal: HD44780_TRACE_RS, HD44780_TRACE_RW or HD44780_TRACE_E
+ * @retval Pulse width in nanoseconds or UINT32_MAX if no complete pulse found
+ */
+uint32_t
+HD44780_Trace_MinPulseWidth(const HD44780_Trace_t *Trace, uint8_t Signal)
+{
+  const HD44780_TraceEvent_t *event;
+  uint32_t minWidth = UINT32_MAX;
+  uint32_t riseTime = 0;
+  uint8_t level = 0;
+  uint8_t riseValid = 0;
+  uint16_t i;
+
+  for (i = 0; i < Trace->Count; i++)
+  {
+    event = HD44780_Trace_GetEvent(Trace, i);
+    if (event->Signal != Signal || event->Value == level)
+      continue;
+
+    level = event->Value;
+    if (level)
+    {
+      riseTime = event->Time;
+      riseValid = 1;
+    }
+    else if (riseValid)
+    {
+      if ((uint32_t)(event->Time - riseTime) < minWidth)
+        minWidth = event->Time - riseTime;
+    }
+  }
+
+  return minWidth;
+}
+
+/**
+ * @brief  Dump recorded events in Value Change Dump format (for GTKWave)
+ * @note   Dump times are summed from the gaps between events, so a capture
+ *         may be longer than the 4.29 s range of the event times as long as
+ *         no gap is.
+ * @param  Trace: Pointer to trace recorder
+ * @param  Write: Function to output null terminated pieces of the dump
+ * @retval None
+ */
+void
+HD44780_Trace_DumpVCD(const HD44780_Trace_t *Trace, void (*Write)(const char *))
+{
+  const HD44780_TraceEvent_t *event;
+  uint32_t lastTime = 0;
+  uint64_t time = 0; // event times wrap after about 4.29 s
+  char buf[21];
+  char id[2] = {0, 0};
+  char value[7];
+  uint16_t i;
+  uint8_t signal;
+  uint8_t bit;
+
+  Write("$timescale 1ns $end\n");
+  Write("$scope module hd44780 $end\n");
+  for (signal = 0; signal < HD44780_TRACE_SIGNALS; signal++)
+  {
+    id[0] = '!' + signal;
+    Write("$var wire ");
+    Write(HD44780_Trace_UIntToStr(SignalWidth[signal], buf));
+    Write(" ");
+    Write(id);
+    Write(" ");
+    Write(SignalName[signal]);
+    Write(" $end\n");
+  }
+  Write("$upscope $end\n");
+  Write("$enddefinitions $end\n");
+
+  // Signal levels before the first recorded event are unknown
+  Write("$dumpvars\n");
+  for (signal = 0; signal < HD44780_TRACE_SIGNALS; signal++)
+  {
+    id[0] = '!' + signal;
+    Write(SignalWidth[signal] == 1 ? "x" : "bx ");
+    Write(id);
+    Write("\n");
+  }
+  Write("$end\n");
+
+  if (Trace->Count)
+    lastTime = HD44780_Trace_GetEvent(Trace, 0)->Time;
+
+  for (i = 0; i < Trace->Count; i++)
+  {
+    event = HD44780_Trace_GetEvent(Trace, i);
+
+    if (event->Time != lastTime || i == 0)
+    {
+      time += (uint32_t)(event->Time - lastTime);
+      lastTime = event->Time;
+      Write("#");
+      Write(HD44780_Trace_UIntToStr(time, buf));
+      Write("\n");
+    }
+
+    id[0] = '!' + event->Signal;
+    if (SignalWidth[event->Signal] == 1)
+    {
+      value[0] = event->Value ? '1' : '0';
+      value[1] = '\0';
+    }
+    else
+    {
+      value[0] = 'b';
+      for (bit = 0; bit < 4; bit++)
+        value[1 + bit] = (event->Value & (0x08 >> bit)) ? '1' : '0';
+      value[5] = ' ';
+      value[6] = '\0';
+    }
+    Write(value);
+    Write(id);
+    Write("\n");
+  }
+}
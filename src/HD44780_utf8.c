@@ -0,0 +1,503 @@
+/**
+ **********************************************************************************
+ * @file   HD44780_utf8.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  UTF-8 text output with character ROM mapping and CGRAM fallback
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "HD44780_utf8.h"
+#include <stdio.h>
+
+
+
+/* Private Constants ------------------------------------------------------------*/
+#define HD44780_UTF8_LATIN1_BASE    0x00A0
+#define HD44780_UTF8_GREEK_BASE     0x0390
+#define HD44780_UTF8_CYRILLIC_BASE  0x0410
+#define HD44780_UTF8_BLOCK_SIZE     64
+
+#define HD44780_UTF8_GLYPHS  (sizeof(HD44780_Utf8_Glyphs) / sizeof(HD44780_Utf8_Glyphs[0]))
+
+
+/* Private Data Types -----------------------------------------------------------*/
+typedef struct HD44780_Utf8Glyph_s
+{
+  uint16_t Codepoint;
+  uint8_t Pattern[8];
+} HD44780_Utf8Glyph_t;
+
+
+
+/* Private Variables ------------------------------------------------------------*/
+/**
+ * @brief  Codepoint to character code tables, indexed by (codepoint - base).
+ *         0 means the character is not in ROM. Letters without their own code
+ *         are mapped to look-alike characters.
+ */
+#if HD44780_UTF8_ROM == HD44780_ROM_A00
+
+static const uint8_t HD44780_Utf8_Latin1[96] HD44780_PROGMEM =
+{
+  0x20, 0x00, 0xEC, 0x00, 0x00, 0x5C, 0x00, 0x00,  // U+00A0
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // U+00A8
+  0xDF, 0x00, 0x00, 0x00, 0x00, 0xE4, 0x00, 0xA5,  // U+00B0
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // U+00B8
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // U+00C0
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // U+00C8
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // U+00D0
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE2,  // U+00D8
+  0x00, 0x00, 0x00, 0x00, 0xE1, 0x00, 0x00, 0x00,  // U+00E0
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // U+00E8
+  0x00, 0xEE, 0x00, 0x00, 0x00, 0x00, 0xEF, 0xFD,  // U+00F0
+  0x00, 0x00, 0x00, 0x00, 0xF5, 0x00, 0x00, 0x00,  // U+00F8
+};
+
+static const uint8_t HD44780_Utf8_Greek[HD44780_UTF8_BLOCK_SIZE] HD44780_PROGMEM =
+{
+  0x00, 0x41, 0x42, 0x00, 0x00, 0x45, 0x5A, 0x48,  // U+0390
+  0x00, 0x49, 0x4B, 0x00, 0x4D, 0x4E, 0x00, 0x4F,  // U+0398
+  0x00, 0x50, 0x00, 0xF6, 0x54, 0x59, 0x00, 0x58,  // U+03A0
+  0x00, 0xF4, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // U+03A8
+  0x00, 0xE0, 0xE2, 0x00, 0x00, 0xE3, 0x00, 0x00,  // U+03B0
+  0xF2, 0x00, 0x00, 0x00, 0xE4, 0x00, 0x00, 0x6F,  // U+03B8
+  0xF7, 0xE6, 0x00, 0xE5, 0x00, 0x00, 0x00, 0x00,  // U+03C0
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // U+03C8
+};
+
+static const uint8_t HD44780_Utf8_Cyrillic[HD44780_UTF8_BLOCK_SIZE] HD44780_PROGMEM =
+{
+  0x41, 0x00, 0x42, 0x00, 0x00, 0x45, 0x00, 0x00,  // U+0410
+  0x00, 0x00, 0x4B, 0x00, 0x4D, 0x48, 0x4F, 0x00,  // U+0418
+  0x50, 0x43, 0x54, 0x00, 0x00, 0x58, 0x00, 0x00,  // U+0420
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // U+0428
+  0x61, 0x00, 0x42, 0x00, 0x00, 0x65, 0x00, 0x00,  // U+0430
+  0x00, 0x00, 0x4B, 0x00, 0x4D, 0x48, 0x6F, 0x00,  // U+0438
+  0x70, 0x63, 0x54, 0x79, 0x00, 0x78, 0x00, 0x00,  // U+0440
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // U+0448
+};
+
+#elif HD44780_UTF8_ROM == HD44780_ROM_A02
+
+static const uint8_t HD44780_Utf8_Latin1[96] HD44780_PROGMEM =
+{
+  0x20, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,  // U+00A0
+  0x00, 0xA9, 0xAA, 0xAB, 0x00, 0x00, 0xAE, 0x00,  // U+00A8
+  0xB0, 0xB1, 0xB2, 0xB3, 0x00, 0xB5, 0xB6, 0xB7,  // U+00B0
+  0x00, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,  // U+00B8
+  0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7,  // U+00C0
+  0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,  // U+00C8
+  0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7,  // U+00D0
+  0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF,  // U+00D8
+  0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7,  // U+00E0
+  0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF,  // U+00E8
+  0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7,  // U+00F0
+  0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF,  // U+00F8
+};
+
+static const uint8_t HD44780_Utf8_Greek[HD44780_UTF8_BLOCK_SIZE] HD44780_PROGMEM =
+{
+  0x00, 0x41, 0x42, 0x92, 0x00, 0x45, 0x5A, 0x48,  // U+0390
+  0x99, 0x49, 0x4B, 0x00, 0x4D, 0x4E, 0x00, 0x4F,  // U+0398
+  0x00, 0x50, 0x00, 0x94, 0x54, 0x59, 0x00, 0x58,  // U+03A0
+  0x00, 0x9A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // U+03A8
+  0x00, 0x90, 0x00, 0x00, 0x9B, 0x9E, 0x00, 0x00,  // U+03B0
+  0x00, 0x00, 0x00, 0x00, 0xB5, 0x00, 0x00, 0x6F,  // U+03B8
+  0x93, 0x00, 0x00, 0x95, 0x97, 0x00, 0x00, 0x00,  // U+03C0
+  0x00, 0xB8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // U+03C8
+};
+
+static const uint8_t HD44780_Utf8_Cyrillic[HD44780_UTF8_BLOCK_SIZE] HD44780_PROGMEM =
+{
+  0x41, 0x80, 0x42, 0x92, 0x81, 0x45, 0x82, 0x83,  // U+0410
+  0x84, 0x85, 0x4B, 0x86, 0x4D, 0x48, 0x4F, 0x87,  // U+0418
+  0x50, 0x43, 0x54, 0x88, 0x00, 0x58, 0x89, 0x8A,  // U+0420
+  0x8B, 0x8C, 0x8D, 0x8E, 0x00, 0x8F, 0xAC, 0xAD,  // U+0428
+  0x61, 0x80, 0x42, 0x92, 0x81, 0x65, 0x82, 0x83,  // U+0430
+  0x84, 0x85, 0x4B, 0x86, 0x4D, 0x48, 0x6F, 0x87,  // U+0438
+  0x70, 0x63, 0x54, 0x79, 0x00, 0x78, 0x89, 0x8A,  // U+0440
+  0x8B, 0x8C, 0x8D, 0x8E, 0x00, 0x8F, 0xAC, 0xAD,  // U+0448
+};
+
+#else
+#error "Unknown HD44780_UTF8_ROM"
+#endif
+
+#if (HD44780_CONFIG_CGRAM)
+/**
+ * @brief  Bundled 5x8 glyphs for characters missing from ROM (sorted)
+ */
+static const HD44780_Utf8Glyph_t HD44780_Utf8_Glyphs[] HD44780_PROGMEM =
+{
+  {0x005C, {0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, 0x00}}, // backslash
+  {0x007E, {0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00, 0x00}}, // tilde
+  {0x00C4, {0x0A, 0x00, 0x0E, 0x11, 0x1F, 0x11, 0x11, 0x00}}, // A with diaeresis
+  {0x00D6, {0x0A, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E, 0x00}}, // O with diaeresis
+  {0x00DC, {0x0A, 0x00, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00}}, // U with diaeresis
+  {0x0424, {0x04, 0x0E, 0x15, 0x15, 0x15, 0x0E, 0x04, 0x00}}, // Cyrillic EF
+  {0x042C, {0x10, 0x10, 0x10, 0x1E, 0x11, 0x11, 0x1E, 0x00}}, // Cyrillic soft sign
+  {0x20AC, {0x06, 0x09, 0x1C, 0x08, 0x1C, 0x09, 0x06, 0x00}}, // euro sign
+};
+#endif
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static uint8_t
+HD44780_Utf8_ToRomMisc(uint16_t Codepoint)
+{
+  switch (Codepoint)
+  {
+#if HD44780_UTF8_ROM == HD44780_ROM_A00
+  case 0x2190: return 0x7F; // leftwards arrow
+  case 0x2192: return 0x7E; // rightwards arrow
+  case 0x221A: return 0xE8; // square root
+  case 0x221E: return 0xF3; // infinity
+  case 0x2588: return 0xFF; // full block
+#else
+  case 0x0401: return 0xCB; // Cyrillic IO
+  case 0x0451: return 0xEB; // Cyrillic io
+  case 0x201C: return 0x12; // left double quotation mark
+  case 0x201D: return 0x13; // right double quotation mark
+  case 0x2190: return 0x1B; // leftwards arrow
+  case 0x2191: return 0x18; // upwards arrow
+  case 0x2192: return 0x1A; // rightwards arrow
+  case 0x2193: return 0x19; // downwards arrow
+  case 0x221E: return 0x9C; // infinity
+  case 0x2264: return 0x1C; // less-than or equal to
+  case 0x2265: return 0x1D; // greater-than or equal to
+  case 0x25B2: return 0x1E; // black up-pointing triangle
+  case 0x25B6: return 0x10; // black right-pointing triangle
+  case 0x25BC: return 0x1F; // black down-pointing triangle
+  case 0x25C0: return 0x11; // black left-pointing triangle
+  case 0x25CF: return 0x16; // black circle
+  case 0x2665: return 0x9D; // black heart suit
+  case 0x266A: return 0x91; // eighth note
+#endif
+  default:     return 0;
+  }
+}
+
+#if (HD44780_CONFIG_CGRAM)
+static HD44780_Result_t
+HD44780_Utf8_Glyph(HD44780_Utf8_t *Utf8, uint16_t Codepoint)
+{
+  const HD44780_Utf8Glyph_t *glyph = NULL;
+  HD44780_Result_t result;
+  uint8_t slot;
+  uint8_t end;
+  uint8_t i;
+
+  // Lowercase Cyrillic letters share the glyph of uppercase ones
+  if (Codepoint >= HD44780_UTF8_CYRILLIC_BASE + 0x20 &&
+      Codepoint < HD44780_UTF8_CYRILLIC_BASE + HD44780_UTF8_BLOCK_SIZE)
+    Codepoint -= 0x20;
+
+  for (i = 0; i < HD44780_UTF8_GLYPHS; i++)
+  {
+    if (HD44780_READ_FLASH_WORD(&HD44780_Utf8_Glyphs[i].Codepoint) == Codepoint)
+    {
+      glyph = &HD44780_Utf8_Glyphs[i];
+      break;
+    }
+  }
+
+  if (glyph == NULL)
+    return HD44780_Data(Utf8->Handler, HD44780_UTF8_REPLACEMENT);
+
+  end = Utf8->First + Utf8->Count;
+
+  // Already loaded?
+  for (slot = Utf8->First; slot < end; slot++)
+  {
+    if (Utf8->Slots[slot] == Codepoint)
+      return HD44780_Data(Utf8->Handler, slot);
+  }
+
+  for (slot = Utf8->First; slot < end; slot++)
+  {
+    if (Utf8->Slots[slot] == 0)
+      break;
+  }
+
+  if (slot == end)
+    return HD44780_Data(Utf8->Handler, HD44780_UTF8_REPLACEMENT);
+
+  Utf8->Slots[slot] = Codepoint;
+  result = HD44780_CreateChar_P(Utf8->Handler, slot, glyph->Pattern);
+  if (HD44780_Data(Utf8->Handler, slot) != HD44780_OK)
+    result = HD44780_FAIL;
+
+  return result;
+}
+#endif
+
+// Smallest codepoint encoded with Length continuation bytes
+static uint32_t
+HD44780_Utf8_MinCodepoint(uint8_t Length)
+{
+  if (Length == 1)
+    return 0x80;
+  if (Length == 2)
+    return 0x800;
+
+  return 0x10000;
+}
+
+static HD44780_Result_t
+HD44780_Utf8_Emit(HD44780_Utf8_t *Utf8, uint32_t Codepoint)
+{
+  uint8_t code;
+
+  if (Codepoint == '\n')
+    return HD44780_Putc(Utf8->Handler, '\n');
+
+  // Control characters (e.g. CGRAM codes) are written as they are
+  if (Codepoint < 0x20)
+    return HD44780_Data(Utf8->Handler, Codepoint);
+
+  if (Codepoint > 0xFFFF)
+    return HD44780_Data(Utf8->Handler, HD44780_UTF8_REPLACEMENT);
+
+  code = HD44780_Utf8_ToRom(Codepoint);
+  if (code)
+    return HD44780_Data(Utf8->Handler, code);
+
+#if (HD44780_CONFIG_CGRAM)
+  return HD44780_Utf8_Glyph(Utf8, Codepoint);
+#else
+  return HD44780_Data(Utf8->Handler, HD44780_UTF8_REPLACEMENT);
+#endif
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize UTF-8 output
+ * @note   All CGRAM locations are used for glyphs. Use HD44780_Utf8_SetSlots()
+ *         to leave some of them to other modules (e.g. bar graphs).
+ * @param  Utf8: Pointer to UTF-8 output
+ * @param  Handler: Pointer to initialized handler
+ * @retval None
+ */
+void
+HD44780_Utf8_Init(HD44780_Utf8_t *Utf8, HD44780_Handler_t *Handler)
+{
+  Utf8->Handler = Handler;
+  Utf8->Codepoint = 0;
+  Utf8->Remaining = 0;
+  Utf8->Length = 0;
+  Utf8->First = 0;
+  Utf8->Count = 8;
+  HD44780_Utf8_ResetGlyphs(Utf8);
+}
+
+/**
+ * @brief  Select the CGRAM locations used for glyphs
+ * @note   Locations outside First to First + Count - 1 are never written, so
+ *         they can be used by other modules. The selected locations are freed.
+ * @param  Utf8: Pointer to UTF-8 output
+ * @param  First: First CGRAM location
+ * @param  Count: Number of locations (0 to 8 - First)
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Locations are out of range.
+ */
+HD44780_Result_t
+HD44780_Utf8_SetSlots(HD44780_Utf8_t *Utf8, uint8_t First, uint8_t Count)
+{
+  if (First > 8 || Count > 8 - First)
+    return HD44780_FAIL;
+
+  Utf8->First = First;
+  Utf8->Count = Count;
+  HD44780_Utf8_ResetGlyphs(Utf8);
+
+  return HD44780_OK;
+}
+
+/**
+ * @brief  Feed one byte of UTF-8 text
+ * @note   Characters missing from ROM are displayed using a bundled glyph,
+ *         uploaded to a free CGRAM location of the glyph slots on first use.
+ *         When all slots are used (or HD44780_CONFIG_CGRAM is 0),
+ *         HD44780_UTF8_REPLACEMENT is displayed instead, as for malformed
+ *         sequences (including overlong encodings and surrogates).
+ * @param  Utf8: Pointer to UTF-8 output
+ * @param  Byte: Next byte of text
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_Utf8_Putc(HD44780_Utf8_t *Utf8, char Byte)
+{
+  HD44780_Result_t result = HD44780_OK;
+  uint8_t byte = (uint8_t)Byte;
+
+  // Continuation byte
+  if ((byte & 0xC0) == 0x80)
+  {
+    if (Utf8->Remaining == 0)
+      return HD44780_Utf8_Emit(Utf8, HD44780_UTF8_REPLACEMENT);
+
+    Utf8->Codepoint = (Utf8->Codepoint << 6) | (byte & 0x3F);
+    if (--Utf8->Remaining)
+      return HD44780_OK;
+
+    // Overlong encodings and surrogates are not valid characters
+    if (Utf8->Codepoint < HD44780_Utf8_MinCodepoint(Utf8->Length) ||
+        (Utf8->Codepoint >= 0xD800 && Utf8->Codepoint <= 0xDFFF))
+      return HD44780_Utf8_Emit(Utf8, HD44780_UTF8_REPLACEMENT);
+
+    return HD44780_Utf8_Emit(Utf8, Utf8->Codepoint);
+  }
+
+  // A new character starts while the previous one is not complete
+  if (Utf8->Remaining)
+  {
+    Utf8->Remaining = 0;
+    result = HD44780_Utf8_Emit(Utf8, HD44780_UTF8_REPLACEMENT);
+  }
+
+  if (byte < 0x80)
+  {
+    if (HD44780_Utf8_Emit(Utf8, byte) != HD44780_OK)
+      result = HD44780_FAIL;
+    return result;
+  }
+
+  // 0xC0 and 0xC1 only start overlong encodings of ASCII
+  if ((byte & 0xE0) == 0xC0 && byte >= 0xC2)
+  {
+    Utf8->Codepoint = byte & 0x1F;
+    Utf8->Remaining = Utf8->Length = 1;
+  }
+  else if ((byte & 0xF0) == 0xE0)
+  {
+    Utf8->Codepoint = byte & 0x0F;
+    Utf8->Remaining = Utf8->Length = 2;
+  }
+  else if ((byte & 0xF8) == 0xF0)
+  {
+    Utf8->Codepoint = byte & 0x07;
+    Utf8->Remaining = Utf8->Length = 3;
+  }
+  else
+  {
+    if (HD44780_Utf8_Emit(Utf8, HD44780_UTF8_REPLACEMENT) != HD44780_OK)
+      result = HD44780_FAIL;
+  }
+
+  return result;
+}
+
+/**
+ * @brief  Display UTF-8 string
+ * @param  Utf8: Pointer to UTF-8 output
+ * @param  Str: Null terminated UTF-8 string
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_Utf8_Puts(HD44780_Utf8_t *Utf8, const char *Str)
+{
+  HD44780_Result_t result = HD44780_OK;
+
+  while (*Str)
+  {
+    if (HD44780_Utf8_Putc(Utf8, *Str++) != HD44780_OK)
+      result = HD44780_FAIL;
+  }
+
+  return result;
+}
+
+/**
+ * @brief  Free all CGRAM locations used for glyphs (e.g. on screen change)
+ * @note   Characters on the screen that use these locations change when the
+ *         locations are reused.
+ * @param  Utf8: Pointer to UTF-8 output
+ * @retval None
+ */
+void
+HD44780_Utf8_ResetGlyphs(HD44780_Utf8_t *Utf8)
+{
+  uint8_t slot;
+
+  for (slot = 0; slot < 8; slot++)
+    Utf8->Slots[slot] = 0;
+}
+
+/**
+ * @brief  Map a codepoint to the character ROM
+ * @param  Codepoint: Unicode codepoint
+ * @retval Character code or 0 if the character is not in ROM
+ */
+uint8_t
+HD44780_Utf8_ToRom(uint16_t Codepoint)
+{
+  if (Codepoint >= 0x20 && Codepoint < 0x7F)
+  {
+#if HD44780_UTF8_ROM == HD44780_ROM_A00
+    // Replaced by yen sign and right arrow in A00
+    if (Codepoint == '\\' || Codepoint == '~')
+      return 0;
+#endif
+    return Codepoint;
+  }
+
+  if (Codepoint >= HD44780_UTF8_LATIN1_BASE && Codepoint <= 0xFF)
+    return HD44780_READ_FLASH(&HD44780_Utf8_Latin1[Codepoint - HD44780_UTF8_LATIN1_BASE]);
+
+  if (Codepoint >= HD44780_UTF8_GREEK_BASE &&
+      Codepoint < HD44780_UTF8_GREEK_BASE + HD44780_UTF8_BLOCK_SIZE)
+    return HD44780_READ_FLASH(&HD44780_Utf8_Greek[Codepoint - HD44780_UTF8_GREEK_BASE]);
+
+  if (Codepoint >= HD44780_UTF8_CYRILLIC_BASE &&
+      Codepoint < HD44780_UTF8_CYRILLIC_BASE + HD44780_UTF8_BLOCK_SIZE)
+    return HD44780_READ_FLASH(&HD44780_Utf8_Cyrillic[Codepoint - HD44780_UTF8_CYRILLIC_BASE]);
+
+#if HD44780_UTF8_ROM == HD44780_ROM_A00
+  // Halfwidth katakana are in the same order as in ROM
+  if (Codepoint >= 0xFF61 && Codepoint <= 0xFF9F)
+    return Codepoint - 0xFF61 + 0xA1;
+#endif
+
+  return HD44780_Utf8_ToRomMisc(Codepoint);
+}
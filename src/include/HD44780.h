@@ -42,6 +42,99 @@ extern "C" {
 #include <stdint.h>
 
 
+/* Functionality Options --------------------------------------------------------*/
+/**
+ * @brief  Feature switches. Define any of them as 0 (e.g. -DHD44780_CONFIG_READ=0)
+ *         to remove the feature and its code from the build.
+ *         - HD44780_CONFIG_READ: Busy flag and DDRAM reads. If 0, the library
+ *           always works in timed mode and PlatformReadData is never called.
+ *         - HD44780_CONFIG_NEWLINE: Line feed handling of HD44780_Putc() and
+ *           HD44780_Puts(). If 0, '\n' is written as a normal character.
+ *         - HD44780_CONFIG_CGRAM: HD44780_CreateChar().
+ *         - HD44780_CONFIG_WARM_INIT: HD44780_WarmInit().
+ *         - HD44780_CONFIG_SCRUB: HD44780_Scrub().
+ *         - HD44780_CONFIG_TIMING_PRESETS: Timing profiles other than
+ *           HD44780_TIMING_HD44780U.
+ *         - HD44780_CONFIG_RECORD: Reporting of public calls to
+ *           Handler->Record (see HD44780_record.h).
+ *         - HD44780_CONFIG_OPS_FLASH: Operations tables are read from flash
+ *           (avr-gcc __flash). Enabled by default on AVR if the compiler
+ *           supports it. Tables must then be declared with HD44780_OPS_SPACE
+ *           and HD44780_Trace_Attach() is not available.
+ */
+#ifndef HD44780_CONFIG_READ
+#define HD44780_CONFIG_READ           1
+#endif
+
+#ifndef HD44780_CONFIG_NEWLINE
+#define HD44780_CONFIG_NEWLINE        1
+#endif
+
+#ifndef HD44780_CONFIG_CGRAM
+#define HD44780_CONFIG_CGRAM          1
+#endif
+
+#ifndef HD44780_CONFIG_WARM_INIT
+#define HD44780_CONFIG_WARM_INIT      1
+#endif
+
+#ifndef HD44780_CONFIG_SCRUB
+#define HD44780_CONFIG_SCRUB          1
+#endif
+
+#ifndef HD44780_CONFIG_TIMING_PRESETS
+#define HD44780_CONFIG_TIMING_PRESETS 1
+#endif
+
+#ifndef HD44780_CONFIG_RECORD
+#define HD44780_CONFIG_RECORD         1
+#endif
+
+#ifndef HD44780_CONFIG_OPS_FLASH
+#if defined(__AVR__) && defined(__FLASH) && !defined(__cplusplus)
+#define HD44780_CONFIG_OPS_FLASH      1
+#else
+#define HD44780_CONFIG_OPS_FLASH      0
+#endif
+#endif
+
+
+/* Program Memory ---------------------------------------------------------------*/
+/**
+ * @brief  Constant data placed in program memory (flash). On AVR, constants
+ *         are copied to RAM at startup unless they are declared with
+ *         HD44780_PROGMEM, and must then be read with the macros below. On
+ *         other targets flash is in the same address space and these are
+ *         plain reads.
+ * @note   Strings for HD44780_Puts_P() can be declared like this:
+ *         static const char Title[] HD44780_PROGMEM = "Temperature";
+ */
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#define HD44780_PROGMEM                     PROGMEM
+#define HD44780_READ_FLASH(Addr)            pgm_read_byte(Addr)
+#define HD44780_READ_FLASH_WORD(Addr)       pgm_read_word(Addr)
+#define HD44780_COPY_FLASH(Dst, Src, Size)  memcpy_P((Dst), (Src), (Size))
+#else
+#include <string.h>
+#define HD44780_PROGMEM
+#define HD44780_READ_FLASH(Addr)            (*(const uint8_t *)(Addr))
+#define HD44780_READ_FLASH_WORD(Addr)       (*(const uint16_t *)(Addr))
+#define HD44780_COPY_FLASH(Dst, Src, Size)  memcpy((Dst), (Src), (Size))
+#endif
+
+/**
+ * @brief  Address space of operations tables. Declare them like this, so they
+ *         stay in flash on AVR and are read from there by the library:
+ *         static const HD44780_OPS_SPACE HD44780_Ops_t PlatformOps = {...};
+ */
+#if (HD44780_CONFIG_OPS_FLASH)
+#define HD44780_OPS_SPACE                   __flash
+#else
+#define HD44780_OPS_SPACE
+#endif
+
+
 /* Exported Constants -----------------------------------------------------------*/
 /**
  * @brief  HD44780U LCD controller commands
@@ -69,6 +162,90 @@ extern "C" {
 #define HD44780_MOVE_DISP_LEFT    0x18  // shift display left
 #define HD44780_MOVE_DISP_RIGHT   0x1C  // shift display right
 
+/**
+ * @brief  Built-in timing profiles of HD44780-compatible controllers
+ */
+#define HD44780_TIMING_HD44780U   0 // Hitachi HD44780U, Vcc = 4.5 to 5.5 V
+#define HD44780_TIMING_ST7066U    1 // Sitronix ST7066U
+#define HD44780_TIMING_SPLC780D   2 // Sunplus SPLC780D
+#define HD44780_TIMING_KS0066     3 // Samsung KS0066
+#define HD44780_TIMING_SLOW       4 // modules powered from 3.3 V (or lower)
+
+/**
+ * @brief  Handler options
+ */
+#define HD44780_OPT_CALIBRATE  0x01 // measure execution times in HD44780_Init()
+#define HD44780_OPT_TIMED      0x02 // wait for execution times, never read busy flag
+#define HD44780_OPT_RECOVER    0x04 // re-initialize the interface after an error
+
+/**
+ * @brief  Errors detected while reading the busy flag (Handler->Errors)
+ */
+#define HD44780_ERR_TIMEOUT    0x01 // busy flag did not clear in time
+#define HD44780_ERR_DESYNC     0x02 // address counter differs from expected value
+
+/**
+ * @brief  Pass as Y of HD44780_Putv() to write at the current cursor position
+ */
+#define HD44780_CURRENT_POS    0xFF
+
+/**
+ * @brief  Public calls reported to Handler->Record, with their arguments
+ * @note   Text arguments are reported in pieces with HD44780_CALL_MORE set,
+ *         which must be appended to the arguments of the previous call.
+ *         HD44780_Puts_P() is reported as HD44780_CALL_PUTS.
+ */
+#define HD44780_CALL_INIT          0x01 // Lines, Length, DispAttr, Options
+#define HD44780_CALL_WARM_INIT     0x02 // Lines, Length, DispAttr, Options, text
+#define HD44780_CALL_CALIBRATE     0x03 // -
+#define HD44780_CALL_TIMING_PRESET 0x04 // Preset
+#define HD44780_CALL_TIMING        0x05 // timing fields, 16-bit ones little endian
+#define HD44780_CALL_CLEAR         0x06 // -
+#define HD44780_CALL_HOME          0x07 // -
+#define HD44780_CALL_GOTOXY        0x08 // X, Y
+#define HD44780_CALL_SET_PAGE      0x09 // Page
+#define HD44780_CALL_SHOW_PAGE     0x0A // Page
+#define HD44780_CALL_PUTC          0x0B // C
+#define HD44780_CALL_PUTS          0x0C // text
+#define HD44780_CALL_PUTV          0x0D // X, Y, Width, text of all segments
+#define HD44780_CALL_PUT_SCREEN    0x0E // text
+#define HD44780_CALL_COMMAND       0x0F // Cmd
+#define HD44780_CALL_DATA          0x10 // Data
+#define HD44780_CALL_CREATE_CHAR   0x11 // Location, 8 pattern bytes
+#define HD44780_CALL_SCRUB         0x12 // Count
+#define HD44780_CALL_PUT_STATIC    0x13 // static screen stream, 0 terminated
+#define HD44780_CALL_MORE          0x80
+
+
+/* Static Screens ---------------------------------------------------------------*/
+/**
+ * @brief  Describe a fixed screen at compile time. It is stored in program
+ *         memory as a packed stream of runs (length, position, characters)
+ *         and displayed by HD44780_PutStatic() with one cursor move per run.
+ * @note   Runs is a macro that takes the name of a run macro and lists the
+ *         runs with it as RUN(X, Y, Text). X and Y must be plain numbers and
+ *         each run must start at a different position. Text must not be empty
+ *         and is written as it is ('\n' is not interpreted).
+ *         #define BOOT_SCREEN(RUN) \
+ *           RUN(3, 0, "github.com") \
+ *           RUN(2, 1, "Hossein-M98")
+ *         HD44780_STATIC_SCREEN(BootScreen, BOOT_SCREEN);
+ *         ...
+ *         HD44780_PutStatic(&Handler, &BootScreen);
+ */
+#define HD44780_STATIC_SCREEN(Name, Runs)                                       \
+  static const struct { Runs(HD44780_STATIC_FIELD) uint8_t End; }               \
+  Name HD44780_PROGMEM = { Runs(HD44780_STATIC_VALUE) 0 };                      \
+  typedef char Name##_IsPacked[(sizeof(Name) ==                                 \
+                                1 Runs(HD44780_STATIC_SIZE)) ? 1 : -1]
+
+#define HD44780_STATIC_FIELD(X, Y, Text) \
+  struct { uint8_t Len; uint8_t Pos; char Str[sizeof(Text) - 1]; } Run_##Y##_##X;
+#define HD44780_STATIC_VALUE(X, Y, Text) \
+  { sizeof(Text) - 1, ((Y) << 6) | (X), Text },
+#define HD44780_STATIC_SIZE(X, Y, Text) \
+  + 1 + sizeof(Text)
+
 
 /* Exported Data Types ----------------------------------------------------------*/
 /**
@@ -81,32 +258,137 @@ typedef enum HD44780_Result_e
 } HD44780_Result_t;
 
 /**
- * @brief  Handler data type
- * @note   User must initialize this this functions before using library:
- *         - PlatformInitRsRwE
+ * @brief  Part of a text written by HD44780_Putv()
+ */
+typedef struct HD44780_Segment_s
+{
+  const char *Str;
+  uint8_t Len;  // if 0, Str is written until null character
+} HD44780_Segment_t;
+
+/**
+ * @brief  Estimated time of operations on the bus, in microseconds
+ * @note   Each time includes the execution time of the timing profile and the
+ *         transfer of the byte (and the busy flag and address counter reads
+ *         if they are used). Platform overhead is not included.
+ */
+typedef struct HD44780_Cost_s
+{
+  uint16_t CommandUs;  // cursor move or another instruction
+  uint16_t DataUs;     // one character
+  uint16_t ClearUs;    // clear display
+} HD44780_Cost_t;
+
+/**
+ * @brief  Timing profile of the controller
+ * @note   All values are worst-case and include margin. Zero delays are
+ *         skipped completely.
+ */
+typedef struct HD44780_Timing_s
+{
+  uint8_t PowerOnMs;      // wait after power on before the first instruction
+  uint8_t EnablePulseUs;  // E high level width (also data output delay on read)
+  uint8_t EnableCycleUs;  // E low level width between two nibbles
+  uint8_t AddressUs;      // address counter update time after busy flag clears
+  uint8_t PollUs;         // interval between two busy flag reads
+  uint16_t SyncUs;        // wait after the first function set of init sequence
+  uint16_t CommandUs;     // execution time of most instructions
+  uint16_t DataUs;        // execution time of data write
+  uint16_t ClearUs;       // execution time of clear display
+  uint16_t HomeUs;        // execution time of return home
+} HD44780_Timing_t;
+
+/**
+ * @brief  Platform operations data type
+ * @note   Platform must implement these functions:
+ *         - PlatformInitRsRwE (optional)
  *         - PlatformSetValRs
  *         - PlatformSetValRw
  *         - PlatformSetValE
  *         - PlatformSetDirData
  *         - PlatformWriteData
- *         - PlatformReadData
+ *         - PlatformReadData (optional)
  *         - PlatformDelayMs
  *         - PlatformDelayUs
+ *         - PlatformFlush (optional)
+ *         - PlatformGetTimeUs (optional)
+ * @note   If PlatformReadData is NULL, the busy flag can not be read and the
+ *         library waits for the execution time of each instruction (taken from
+ *         the timing profile) instead.
+ * @note   PlatformFlush is called at the end of each operation of the library
+ *         and before reading from the module. Platforms that buffer pin
+ *         changes (e.g. to send them in one transfer) must send the buffer.
+ * @note   PlatformGetTimeUs returns a free running microsecond counter. If it
+ *         is set, timed mode only waits for the part of execution time that
+ *         has not already passed since the last instruction, so the
+ *         application can work meanwhile. It must not be used together with
+ *         PlatformFlush.
+ * @note   The operations are constant and can be shared by several handlers.
+ *         The Context of each handler is passed to them (e.g. pin set of the
+ *         display).
+ */
+typedef struct HD44780_Ops_s
+{
+  void (*PlatformInitRsRwE)(void *Context);
+  void (*PlatformSetValRs)(void *Context, uint8_t Level);
+  void (*PlatformSetValRw)(void *Context, uint8_t Level);
+  void (*PlatformSetValE)(void *Context, uint8_t Level);
+  void (*PlatformSetDirData)(void *Context, uint8_t Dir);
+  void (*PlatformWriteData)(void *Context, uint8_t Data);
+  uint8_t (*PlatformReadData)(void *Context);
+  void (*PlatformDelayMs)(void *Context, uint16_t Delay);
+  void (*PlatformDelayUs)(void *Context, uint16_t Delay);
+  void (*PlatformFlush)(void *Context);
+  uint32_t (*PlatformGetTimeUs)(void *Context);
+} HD44780_Ops_t;
+
+/**
+ * @brief  Handler data type
+ * @note   User must initialize Ops (and Context if the platform needs it)
+ *         before using library.
+ * @note   Options can be set before calling HD44780_Init():
+ *         - HD44780_OPT_CALIBRATE: Measure execution times of this module.
+ *           Times are measured with PlatformGetTimeUs and never set below
+ *           75% of the preset (fastest oscillator of the datasheet). Without
+ *           PlatformGetTimeUs, calibration can only lengthen the preset times.
+ *         - HD44780_OPT_TIMED: Work in timed mode even if busy flag is readable.
+ *         - HD44780_OPT_RECOVER: After a busy flag timeout or an unexpected
+ *           address counter, re-synchronize the 4-bit interface, restore the
+ *           display settings and rewrite Screen (if it is set).
+ * @note   BusyTimeoutUs limits each busy flag wait (0: 8 times the clear
+ *         time, the slowest module accepted by calibration).
+ *         After an error, the rest of the operation waits for execution times
+ *         instead of reading the busy flag, so every call has a bounded
+ *         duration and returns HD44780_FAIL.
+ * @note   Screen is optional. It points to the visible content (Lines *
+ *         Length characters, line after line) kept by the application.
  */
 typedef struct HD44780_Handler_s
 {
   uint8_t Lines;
   uint8_t Length;
-  
-  void (*PlatformInitRsRwE)(void);
-  void (*PlatformSetValRs)(uint8_t);
-  void (*PlatformSetValRw)(uint8_t);
-  void (*PlatformSetValE)(uint8_t);
-  void (*PlatformSetDirData)(uint8_t);
-  void (*PlatformWriteData)(uint8_t);
-  uint8_t (*PlatformReadData)(void);
-  void (*PlatformDelayMs)(uint16_t);
-  void (*PlatformDelayUs)(uint16_t);
+  uint8_t Options;
+  uint16_t BusyTimeoutUs;
+  const char *Screen;
+  uint8_t Errors;     // HD44780_ERR_*, accumulated until cleared by user
+
+  // Optional, called at the start of each public call (HD44780_CALL_*)
+  void (*Record)(void *Context, uint8_t Call, const uint8_t *Args, uint8_t Size);
+  void *RecordContext;
+
+  const HD44780_OPS_SPACE HD44780_Ops_t *Ops;
+  void *Context;
+
+  HD44780_Timing_t Timing;
+  uint16_t PendingUs; // execution time of the last instruction
+  uint32_t ReadyAt;   // end of execution of the last instruction (time in us)
+  uint8_t Address;    // address counter tracked by software
+  uint8_t EntryMode;
+  uint8_t Page;       // page addressed by HD44780_GoToXY()
+  uint8_t Shift;      // display shift tracked by software (0 to 39)
+  uint8_t Display;    // last display on/off control
+  uint8_t Fault;      // errors of the current operation
+  uint8_t ScrubPos;   // next cell checked by HD44780_Scrub()
 } HD44780_Handler_t;
 
 
@@ -133,6 +415,118 @@ HD44780_Init(HD44780_Handler_t *Handler,
              uint8_t DispAttr);
 
 
+#if (HD44780_CONFIG_WARM_INIT)
+/**
+ * @brief  Resume a display that is already powered and initialized (e.g. after
+ *         a watchdog reset of the MCU) without clearing the screen.
+ * @note   The 4-bit interface is re-synchronized and function, entry mode and
+ *         display settings are restored. The cursor is moved to home position.
+ *         HD44780_OPT_CALIBRATE is ignored.
+ * @param  Handler: Pointer to handler
+ * @param  Lines: Number of lines
+ * @param  Length: Number of characters in a line
+ * @param  DispAttr: Display attributes
+ * @param  Expected: Expected screen content (Lines * Length characters, line
+ *                   after line). If the busy flag is readable, only the cells
+ *                   that differ from DDRAM are written, otherwise all cells are
+ *                   written. If NULL, current content is kept.
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_WarmInit(HD44780_Handler_t *Handler,
+                 uint8_t Lines, uint8_t Length,
+                 uint8_t DispAttr, const char *Expected);
+#endif
+
+
+#if (HD44780_CONFIG_SCRUB)
+/**
+ * @brief  Check a few cells of the screen against Handler->Screen and rewrite
+ *         the ones that differ
+ * @note   Each call continues where the previous one stopped and cycles
+ *         through the whole screen, so it can be called from an idle loop to
+ *         repair characters corrupted by noise. The cost of a call is bounded
+ *         by Count. If the busy flag is not readable, the cells are rewritten
+ *         without checking. When the cycle restarts, function, entry mode and
+ *         display settings are sent again. The cursor is preserved.
+ * @param  Handler: Pointer to handler
+ * @param  Count: Number of cells to check
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Handler->Screen is not set, or failed to send or
+ *                         receive data.
+ */
+HD44780_Result_t
+HD44780_Scrub(HD44780_Handler_t *Handler, uint8_t Count);
+#endif
+
+
+
+/**
+ * @brief  Select one of built-in timing profiles
+ * @note   Call this function before HD44780_Init(). HD44780_TIMING_HD44780U
+ *         is used if no timing profile is set.
+ * @param  Handler: Pointer to handler
+ * @param  Preset: Timing profile
+ *         - HD44780_TIMING_HD44780U
+ *         - HD44780_TIMING_ST7066U
+ *         - HD44780_TIMING_SPLC780D
+ *         - HD44780_TIMING_KS0066
+ *         - HD44780_TIMING_SLOW
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Unknown timing profile.
+ */
+HD44780_Result_t
+HD44780_SetTimingPreset(HD44780_Handler_t *Handler, uint8_t Preset);
+
+
+/**
+ * @brief  Set a custom timing profile
+ * @note   Call this function before HD44780_Init().
+ * @param  Handler: Pointer to handler
+ * @param  Timing: Pointer to timing profile. It is copied into the handler.
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Invalid timing profile.
+ */
+HD44780_Result_t
+HD44780_SetTiming(HD44780_Handler_t *Handler, const HD44780_Timing_t *Timing);
+
+
+/**
+ * @brief  Get the time of each operation from the timing profile
+ * @note   Use it after HD44780_Init() (and calibration) to choose between
+ *         ways of updating the screen, e.g. with HD44780_DList_Plan().
+ * @param  Handler: Pointer to handler
+ * @param  Cost: Pointer to cost model that receives the times
+ * @retval None
+ */
+void
+HD44780_GetCost(HD44780_Handler_t *Handler, HD44780_Cost_t *Cost);
+
+
+#if (HD44780_CONFIG_READ)
+/**
+ * @brief  Measure how long the module keeps the busy flag set for clear,
+ *         cursor move and data write, and store the results (with safety
+ *         margin) in the timing profile of handler.
+ * @note   The display is cleared. The measured times are used in timed mode
+ *         (HD44780_OPT_TIMED).
+ * @param  Handler: Pointer to handler
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Busy flag is not readable or it did not clear in
+ *                         time. The timing profile is not changed.
+ */
+HD44780_Result_t
+HD44780_Calibrate(HD44780_Handler_t *Handler);
+#endif
+
+
+
 /**
  * @brief  Clear display and set cursor to home position
  * @param  Handler: Pointer to handler
@@ -168,6 +562,51 @@ HD44780_Result_t
 HD44780_GoToXY(HD44780_Handler_t *Handler, uint8_t X, uint8_t Y);
 
 
+/**
+ * @brief  Get number of pages that fit in DDRAM
+ * @note   Each DDRAM line holds 40 characters. On 1 and 2 line displays, the
+ *         invisible part of the lines is used as more pages of Length
+ *         characters (e.g. 2 pages on a 16x2 display). 4 line displays have
+ *         only one page.
+ * @param  Handler: Pointer to handler
+ * @retval Number of pages
+ */
+uint8_t
+HD44780_PageCount(HD44780_Handler_t *Handler);
+
+
+/**
+ * @brief  Select the page written by next functions
+ * @note   Positions of HD44780_GoToXY() (and functions using it) are
+ *         translated to the selected page. The next screen can be prepared
+ *         on a hidden page and then shown by HD44780_ShowPage(). The cursor
+ *         is not moved.
+ * @param  Handler: Pointer to handler
+ * @param  Page: Page number (0 to HD44780_PageCount() - 1)
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Invalid page.
+ */
+HD44780_Result_t
+HD44780_SetPage(HD44780_Handler_t *Handler, uint8_t Page);
+
+
+/**
+ * @brief  Make a page visible
+ * @note   The display is shifted to the page by the shorter direction, or
+ *         returned home if that is faster (page 0 only). The cursor position
+ *         and DDRAM content are preserved. HD44780_ClearScreen() and
+ *         HD44780_Home() show page 0.
+ * @param  Handler: Pointer to handler
+ * @param  Page: Page number (0 to HD44780_PageCount() - 1)
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Invalid page.
+ */
+HD44780_Result_t
+HD44780_ShowPage(HD44780_Handler_t *Handler, uint8_t Page);
+
+
 /**
  * @brief  Display character at current cursor position
  * @param  Handler: Pointer to handler
@@ -192,7 +631,81 @@ HD44780_Putc(HD44780_Handler_t *Handler, char C);
  *         - HD44780_FAIL: Failed to send or receive data.
  */
 HD44780_Result_t
-HD44780_Puts(HD44780_Handler_t *Handler, char *Str, uint8_t Len);
+HD44780_Puts(HD44780_Handler_t *Handler, const char *Str, uint8_t Len);
+
+
+/**
+ * @brief  Display several strings as one continuous text
+ * @note   The cursor is set once and the segments are written back to back,
+ *         so a line can be composed from a label, a value and a unit without
+ *         copying them into a buffer. Characters are written as they are
+ *         ('\n' is not interpreted).
+ * @param  Handler: Pointer to handler
+ * @param  Segments: Array of segments
+ * @param  Count: Number of segments
+ * @param  X: Start column
+ * @param  Y: Start line, or HD44780_CURRENT_POS to start at the cursor (X is
+ *            ignored)
+ * @param  Width: If not 0, exactly Width characters are written: the text is
+ *                padded with spaces or truncated.
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_Putv(HD44780_Handler_t *Handler,
+             const HD44780_Segment_t *Segments, uint8_t Count,
+             uint8_t X, uint8_t Y, uint8_t Width);
+
+
+/**
+ * @brief  Display string stored in program memory without auto linefeed
+ * @note   Same as HD44780_Puts(), but Str must be declared with HD44780_PROGMEM.
+ *         Characters are read from flash one by one while they are sent.
+ * @param  Handler: Pointer to handler
+ * @param  Str: String to display (in program memory)
+ * @param  Len: Length of string. If 0, string will be displayed until null
+ *              character.
+ * 
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_Puts_P(HD44780_Handler_t *Handler, const char *Str, uint8_t Len);
+
+
+/**
+ * @brief  Display a whole screen template stored in program memory
+ * @note   Template holds Lines rows of Length characters each (no line
+ *         terminators), e.g. a 2x16 template is 32 characters. It is useful
+ *         for static parts of a screen whose values are written afterwards.
+ *         The cursor is left at the end of the last line.
+ * @param  Handler: Pointer to handler
+ * @param  Template: Characters of the screen (in program memory)
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_PutScreen_P(HD44780_Handler_t *Handler, const char *Template);
+
+
+/**
+ * @brief  Display a screen described by HD44780_STATIC_SCREEN()
+ * @note   The cursor is set once for each run. The busy flag (and address
+ *         counter) is checked before each cursor move; characters of a run
+ *         are written back to back after the data write time of the timing
+ *         profile. Other cells are not changed. The cursor is left after the
+ *         last run.
+ * @param  Handler: Pointer to handler
+ * @param  Screen: Pointer to the screen (in program memory)
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_PutStatic(HD44780_Handler_t *Handler, const void *Screen);
 
 
 /**
@@ -220,6 +733,42 @@ HD44780_Result_t
 HD44780_Data(HD44780_Handler_t *Handler, uint8_t Data);
 
 
+#if (HD44780_CONFIG_CGRAM)
+/**
+ * @brief  Define a custom character in CGRAM
+ * @note   The cursor position is preserved.
+ * @param  Handler: Pointer to handler
+ * @param  Location: CGRAM location (0 to 7). The character is displayed by
+ *                   writing this code (or Location + 8) as data.
+ * @param  Pattern: 8 bytes, one per row from top to bottom. Lower 5 bits are
+ *                  the pixels of the row.
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_CreateChar(HD44780_Handler_t *Handler,
+                   uint8_t Location, const uint8_t *Pattern);
+
+
+/**
+ * @brief  Define a custom character in CGRAM from program memory
+ * @note   Same as HD44780_CreateChar(), but Pattern must be declared with
+ *         HD44780_PROGMEM.
+ * @param  Handler: Pointer to handler
+ * @param  Location: CGRAM location (0 to 7)
+ * @param  Pattern: 8 bytes, one per row from top to bottom (in program memory)
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_CreateChar_P(HD44780_Handler_t *Handler,
+                     uint8_t Location, const uint8_t *Pattern);
+#endif
+
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,155 @@
+/**
+ **********************************************************************************
+ * @file   HD44780_bar.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Bar graphs with partial-cell custom characters
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _HD44780_BAR_H_
+#define _HD44780_BAR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "HD44780.h"
+
+
+/* Exported Constants -----------------------------------------------------------*/
+/**
+ * @brief  Number of CGRAM locations used by the glyphs (1 to 5 columns)
+ */
+#define HD44780_BAR_GLYPHS   5
+
+/**
+ * @brief  Columns of one cell
+ */
+#define HD44780_BAR_COLUMNS  5
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  Horizontal bar graph data type
+ * @note   Value and Drawn are internal. They hold the state of the display, so
+ *         an update only writes the cells that change.
+ */
+typedef struct HD44780_Bar_s
+{
+  uint8_t X;
+  uint8_t Y;
+  uint8_t Length; // length in cells
+  uint8_t Glyph;  // CGRAM location of the 1 column glyph
+  uint16_t Value; // columns shown (0 to Length * 5)
+  uint8_t Drawn;  // the bar has been drawn since HD44780_Bar_Init()
+} HD44780_Bar_t;
+
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####                               
+ ==================================================================================
+ */
+
+#if (HD44780_CONFIG_CGRAM)
+/**
+ * @brief  Load the glyphs of partially filled cells into CGRAM
+ * @note   Must be called once after HD44780_Init(). The glyphs take
+ *         HD44780_BAR_GLYPHS consecutive locations (Location to Location + 4)
+ *         and can be shared by all bars of the display. The other three
+ *         locations stay free; when the UTF-8 output is used too, give them to
+ *         it with HD44780_Utf8_SetSlots() (e.g. Location 0 and slots 5 to 7).
+ * @param  Handler: Pointer to handler
+ * @param  Location: First CGRAM location (0 to 3)
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data, or Location is out
+ *                         of range.
+ */
+HD44780_Result_t
+HD44780_Bar_LoadGlyphs(HD44780_Handler_t *Handler, uint8_t Location);
+
+
+/**
+ * @brief  Initialize a bar
+ * @note   Nothing is written to the display. The first call of
+ *         HD44780_Bar_Set() draws the whole bar.
+ * @param  Bar: Pointer to bar
+ * @param  X: X position of the first cell
+ * @param  Y: Line of the bar
+ * @param  Length: Length in cells
+ * @param  Glyph: Location passed to HD44780_Bar_LoadGlyphs()
+ * @retval None
+ */
+void
+HD44780_Bar_Init(HD44780_Bar_t *Bar,
+                 uint8_t X, uint8_t Y, uint8_t Length, uint8_t Glyph);
+
+
+/**
+ * @brief  Show a new value on the bar
+ * @note   Only the cells between the old and the new end of the bar are
+ *         written (one or two for a small change), so the time of an update
+ *         does not depend on the length of the bar. The cursor is left after
+ *         the last written cell.
+ * @param  Handler: Pointer to handler
+ * @param  Bar: Pointer to bar
+ * @param  Value: Value to show (0 to Max)
+ * @param  Max: Value of a full bar. If 0, Value is the number of columns
+ *              (0 to Length * 5).
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_Bar_Set(HD44780_Handler_t *Handler, HD44780_Bar_t *Bar,
+                uint16_t Value, uint16_t Max);
+
+
+/**
+ * @brief  Draw the whole bar again
+ * @note   Call after the display has been cleared or overwritten.
+ * @param  Handler: Pointer to handler
+ * @param  Bar: Pointer to bar
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_Bar_Draw(HD44780_Handler_t *Handler, HD44780_Bar_t *Bar);
+#endif
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  //! _HD44780_BAR_H_
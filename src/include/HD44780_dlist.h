@@ -0,0 +1,294 @@
+/**
+ **********************************************************************************
+ * @file   HD44780_dlist.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Recordable display lists with a peephole optimizer
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _HD44780_DLIST_H_
+#define _HD44780_DLIST_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "HD44780.h"
+
+
+/* Functionality Options --------------------------------------------------------*/
+/**
+ * @brief  Largest display handled by HD44780_DList_Optimize() (Lines * Length).
+ *         The optimizer keeps three bytes per cell on the stack (240 bytes
+ *         with the default of 80 cells).
+ */
+#ifndef HD44780_DLIST_CELLS
+#define HD44780_DLIST_CELLS  80
+#endif
+
+
+/* Exported Constants -----------------------------------------------------------*/
+/**
+ * @brief  Operations of a display list
+ */
+#define HD44780_DLIST_POS    0x01 // Arg: (Y << 6) | X
+#define HD44780_DLIST_DATA   0x02 // Arg: character
+#define HD44780_DLIST_CMD    0x03 // Arg: instruction
+#define HD44780_DLIST_CLEAR  0x04
+#define HD44780_DLIST_HOME   0x05
+#define HD44780_DLIST_VAR    0x10 // + variable index, Arg: width
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  One operation of a display list
+ */
+typedef struct HD44780_DListEntry_s
+{
+  uint8_t Code;
+  uint8_t Arg;
+} HD44780_DListEntry_t;
+
+/**
+ * @brief  Display list data type
+ * @note   Entries is supplied by the user and holds Size operations.
+ */
+typedef struct HD44780_DList_s
+{
+  HD44780_DListEntry_t *Entries;
+  uint16_t Size;
+  uint16_t Count;
+} HD44780_DList_t;
+
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####                               
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize an empty display list
+ * @param  List: Pointer to display list
+ * @param  Entries: Array of Size operations
+ * @param  Size: Number of operations that fit in Entries
+ * @retval None
+ */
+void
+HD44780_DList_Init(HD44780_DList_t *List,
+                   HD44780_DListEntry_t *Entries, uint16_t Size);
+
+
+/**
+ * @brief  Remove all operations of the list
+ * @param  List: Pointer to display list
+ * @retval None
+ */
+void
+HD44780_DList_Reset(HD44780_DList_t *List);
+
+
+/**
+ * @brief  Record a cursor move (see HD44780_GoToXY())
+ * @param  List: Pointer to display list
+ * @param  X: Column
+ * @param  Y: Line
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: List is full.
+ */
+HD44780_Result_t
+HD44780_DList_GoToXY(HD44780_DList_t *List, uint8_t X, uint8_t Y);
+
+
+/**
+ * @brief  Record writing a character at the cursor
+ * @note   Characters are written as they are ('\n' is not interpreted).
+ * @param  List: Pointer to display list
+ * @param  C: Character
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: List is full.
+ */
+HD44780_Result_t
+HD44780_DList_Putc(HD44780_DList_t *List, char C);
+
+
+/**
+ * @brief  Record writing a string at the cursor
+ * @note   Characters are written as they are ('\n' is not interpreted).
+ * @param  List: Pointer to display list
+ * @param  Str: String to write
+ * @param  Len: Length of string. If 0, string will be written until null
+ *              character.
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: List is full (the string is partially recorded).
+ */
+HD44780_Result_t
+HD44780_DList_Puts(HD44780_DList_t *List, const char *Str, uint8_t Len);
+
+
+/**
+ * @brief  Record a variable field of fixed width at the cursor
+ * @note   The text is taken from Vars[Index] of HD44780_DList_Play(), padded
+ *         with spaces or truncated to Width characters. This way a list can be
+ *         optimized once and played with different values.
+ * @param  List: Pointer to display list
+ * @param  Index: Index of the variable (0 to 15)
+ * @param  Width: Number of characters of the field (1 to 40)
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: List is full or invalid parameters.
+ */
+HD44780_Result_t
+HD44780_DList_PutVar(HD44780_DList_t *List, uint8_t Index, uint8_t Width);
+
+
+/**
+ * @brief  Record an instruction (see HD44780_Command())
+ * @note   Clear display and return home are recorded as HD44780_DList_Clear()
+ *         and HD44780_DList_Home().
+ * @param  List: Pointer to display list
+ * @param  Cmd: Instruction
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: List is full.
+ */
+HD44780_Result_t
+HD44780_DList_Command(HD44780_DList_t *List, uint8_t Cmd);
+
+
+/**
+ * @brief  Record clearing the screen (see HD44780_ClearScreen())
+ * @param  List: Pointer to display list
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: List is full.
+ */
+HD44780_Result_t
+HD44780_DList_Clear(HD44780_DList_t *List);
+
+
+/**
+ * @brief  Record moving the cursor home (see HD44780_Home())
+ * @param  List: Pointer to display list
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: List is full.
+ */
+HD44780_Result_t
+HD44780_DList_Home(HD44780_DList_t *List);
+
+
+/**
+ * @brief  Write an optimized copy of a list
+ * @note   The result leaves the same screen content, cursor position and
+ *         display settings as Src:
+ *         - Cursor moves are only issued before a write that needs them.
+ *         - Writes of a cell that is overwritten later (or cleared) are
+ *           removed, as well as writes of the value a cell already has
+ *           because of an earlier write of the list.
+ *         - The remaining writes between two other operations are sorted into
+ *           runs of adjacent cells that need a single cursor move.
+ *         - Display control and entry mode instructions that do not change
+ *           the setting are removed.
+ *         Content of the screen before the list is played is not known, so
+ *         the first write of each cell is always kept. The list is assumed to
+ *         start in the default entry mode (increment, no shift). Writes after
+ *         other instructions that move the cursor are kept as they are.
+ * @param  Dst: Pointer to display list that receives the result
+ * @param  Src: Pointer to recorded display list
+ * @param  Lines: Number of lines of the display
+ * @param  Length: Number of characters in a line
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Dst is too small, the display is larger than
+ *                         HD44780_DLIST_CELLS or Src has an unknown operation.
+ */
+HD44780_Result_t
+HD44780_DList_Optimize(HD44780_DList_t *Dst, const HD44780_DList_t *Src,
+                       uint8_t Lines, uint8_t Length);
+
+
+/**
+ * @brief  Plan the cheapest update of a region from its old to its new content
+ * @note   Only changed cells are written. In each line, a gap of unchanged
+ *         cells between two changes is either skipped with a cursor move or
+ *         bridged by writing its characters again, whichever is cheaper. If
+ *         MayClear is 1, clearing the display and writing the non-space
+ *         characters is used instead when it is cheaper. The cursor position
+ *         after the plan is not defined.
+ * @param  Dst: Pointer to display list that receives the plan
+ * @param  Cost: Pointer to cost model (see HD44780_GetCost())
+ * @param  Old: Current content of the region (Width * Height characters, line
+ *              after line), or NULL if it is not known.
+ * @param  New: New content of the region
+ * @param  X: Column of top left corner of the region
+ * @param  Y: Line of top left corner of the region
+ * @param  Width: Width of the region
+ * @param  Height: Height of the region
+ * @param  MayClear: 1 if the region is the whole screen and clearing the
+ *                   display is allowed
+ * @param  TimeUs: Receives the estimated time of the plan. Can be NULL.
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Dst is too small.
+ */
+HD44780_Result_t
+HD44780_DList_Plan(HD44780_DList_t *Dst, const HD44780_Cost_t *Cost,
+                   const char *Old, const char *New,
+                   uint8_t X, uint8_t Y, uint8_t Width, uint8_t Height,
+                   uint8_t MayClear, uint32_t *TimeUs);
+
+
+/**
+ * @brief  Play a display list on a handler
+ * @param  List: Pointer to display list
+ * @param  Handler: Pointer to initialized handler
+ * @param  Vars: Texts of variable fields (see HD44780_DList_PutVar()). Can be
+ *               NULL if the list has no variable fields.
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data, or the list has an
+ *                         unknown operation (skipped).
+ */
+HD44780_Result_t
+HD44780_DList_Play(const HD44780_DList_t *List, HD44780_Handler_t *Handler,
+                   const HD44780_Segment_t *Vars);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  //! _HD44780_DLIST_H_
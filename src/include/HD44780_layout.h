@@ -0,0 +1,166 @@
+/**
+ **********************************************************************************
+ * @file   HD44780_layout.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Region based screen layout with per-region refresh rates
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _HD44780_LAYOUT_H_
+#define _HD44780_LAYOUT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "HD44780.h"
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  Rectangular region of the screen
+ * @note   Buffer is supplied by the user and must hold Width * Height
+ *         characters (row after row).
+ */
+typedef struct HD44780_Region_s
+{
+  uint8_t X;
+  uint8_t Y;
+  uint8_t Width;
+  uint8_t Height;
+  uint16_t IntervalMs; // minimum time between two refreshes (0: on change)
+  uint8_t Dirty;
+  uint32_t LastUpdate; // time of last refresh in milliseconds
+  char *Buffer;
+} HD44780_Region_t;
+
+/**
+ * @brief  Layout data type
+ */
+typedef struct HD44780_Layout_s
+{
+  HD44780_Handler_t *Handler;
+  HD44780_Region_t *Regions;
+  uint8_t Count;
+  uint8_t Next;        // region to check first in next update
+  uint16_t CellBudget; // maximum characters written per update (0: no limit)
+} HD44780_Layout_t;
+
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####                               
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize a region and fill it with spaces
+ * @param  Region: Pointer to region
+ * @param  X: X position of top left corner
+ * @param  Y: Y position of top left corner
+ * @param  Width: Width in characters
+ * @param  Height: Height in lines
+ * @param  IntervalMs: Minimum time between two refreshes in milliseconds. If 0,
+ *                     the region is refreshed on change.
+ * @param  Buffer: Pointer to Width * Height characters
+ * @retval None
+ */
+void
+HD44780_Region_Init(HD44780_Region_t *Region,
+                    uint8_t X, uint8_t Y, uint8_t Width, uint8_t Height,
+                    uint16_t IntervalMs, char *Buffer);
+
+
+/**
+ * @brief  Render text into the region
+ * @note   Text is clipped at the end of the line. The region is marked dirty
+ *         only if its content changes.
+ * @param  Region: Pointer to region
+ * @param  Col: Column inside region
+ * @param  Row: Row inside region
+ * @param  Str: String to render
+ * @param  Len: Length of string. If 0, string will be rendered until null
+ *              character.
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Position is outside of region.
+ */
+HD44780_Result_t
+HD44780_Region_Puts(HD44780_Region_t *Region, uint8_t Col, uint8_t Row,
+                    const char *Str, uint8_t Len);
+
+
+/**
+ * @brief  Fill the region with spaces
+ * @param  Region: Pointer to region
+ * @retval None
+ */
+void
+HD44780_Region_Clear(HD44780_Region_t *Region);
+
+
+/**
+ * @brief  Initialize the layout
+ * @param  Layout: Pointer to layout
+ * @param  Handler: Pointer to initialized handler
+ * @param  Regions: Array of initialized regions
+ * @param  Count: Number of regions
+ * @param  CellBudget: Maximum characters written per update. If 0, all due
+ *                     regions are written in each update.
+ * @retval None
+ */
+void
+HD44780_Layout_Init(HD44780_Layout_t *Layout, HD44780_Handler_t *Handler,
+                    HD44780_Region_t *Regions, uint8_t Count,
+                    uint16_t CellBudget);
+
+
+/**
+ * @brief  Write regions that are both dirty and due to the display
+ * @note   Regions are checked round robin starting after the last written one,
+ *         so a fast changing region can not starve the others. A region is
+ *         always written completely, even if it exceeds the remaining budget.
+ *         A region that could not be written stays dirty.
+ * @param  Layout: Pointer to layout
+ * @param  NowMs: Current time in milliseconds
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_Layout_Update(HD44780_Layout_t *Layout, uint32_t NowMs);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  //! _HD44780_LAYOUT_H_
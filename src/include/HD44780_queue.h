@@ -0,0 +1,281 @@
+/**
+ **********************************************************************************
+ * @file   HD44780_queue.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Lock-free multi-producer submission queue for HD44780 driver
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _HD44780_QUEUE_H_
+#define _HD44780_QUEUE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "HD44780.h"
+
+
+/* Functionality Options --------------------------------------------------------*/
+/**
+ * @brief  Number of entries in the queue. It must be a power of two.
+ */
+#ifndef HD44780_QUEUE_SIZE
+#define HD44780_QUEUE_SIZE      16
+#endif
+
+/**
+ * @brief  Number of entries in the urgent lane. It must be a power of two.
+ */
+#ifndef HD44780_QUEUE_URGENT_SIZE
+#define HD44780_QUEUE_URGENT_SIZE 4
+#endif
+
+/**
+ * @brief  Maximum number of characters in a single entry
+ */
+#ifndef HD44780_QUEUE_TEXT_MAX
+#define HD44780_QUEUE_TEXT_MAX  8
+#endif
+
+/**
+ * @brief  Synchronization method
+ * @note   C11 atomics are used when available. Otherwise (or if
+ *         HD44780_QUEUE_CRITICAL is defined) the queue indexes are updated in
+ *         short critical sections. On AVR interrupts are disabled for that,
+ *         on other platforms HD44780_QUEUE_ENTER_CRITICAL() and
+ *         HD44780_QUEUE_EXIT_CRITICAL() must be defined by the user.
+ */
+#if !defined(HD44780_QUEUE_CRITICAL) && !defined(__AVR__) && \
+    defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && \
+    !defined(__STDC_NO_ATOMICS__) && !defined(__cplusplus)
+#define HD44780_QUEUE_ATOMIC  1
+#else
+#define HD44780_QUEUE_ATOMIC  0
+#endif
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+#if HD44780_QUEUE_ATOMIC
+#include <stdatomic.h>
+typedef atomic_uint HD44780_QueueSeq_t;
+#else
+typedef volatile unsigned int HD44780_QueueSeq_t;
+#endif
+
+/**
+ * @brief  Queue entry data type
+ */
+typedef struct HD44780_QueueEntry_s
+{
+  HD44780_QueueSeq_t Sequence;
+  uint8_t X;
+  uint8_t Y;
+  uint8_t Len;
+  uint8_t Priority;
+  char Text[HD44780_QUEUE_TEXT_MAX];
+} HD44780_QueueEntry_t;
+
+/**
+ * @brief  Lane (ring of entries) data type
+ */
+typedef struct HD44780_QueueLane_s
+{
+  HD44780_QueueSeq_t Head; // next position to post (producers)
+  unsigned int Tail;       // next position to process (consumer)
+  unsigned int Mask;       // number of entries - 1
+  HD44780_QueueEntry_t *Entries;
+} HD44780_QueueLane_t;
+
+/**
+ * @brief  Queue data type
+ * @note   Entries of the urgent lane preempt the routine work at the next
+ *         byte boundary.
+ * @note   In coalescing mode, posted characters are collected in Pending
+ *         (Lines * Length characters) and State (0: clean, otherwise
+ *         priority + 1) before they are written to the display.
+ */
+typedef struct HD44780_Queue_s
+{
+  HD44780_Handler_t *Handler;
+
+  HD44780_QueueLane_t Routine;
+  HD44780_QueueLane_t Urgent;
+  HD44780_QueueEntry_t RoutineEntries[HD44780_QUEUE_SIZE];
+  HD44780_QueueEntry_t UrgentEntries[HD44780_QUEUE_URGENT_SIZE];
+
+  // Coalescing mode
+  char *Pending;
+  uint8_t *State;
+  uint16_t BudgetUs;       // estimated bus time per process call (0: no limit)
+
+  HD44780_Result_t Result; // result of the driver calls of a process call
+} HD44780_Queue_t;
+
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####                               
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize the queue
+ * @param  Queue: Pointer to queue
+ * @param  Handler: Pointer to initialized handler the queue is drained to
+ * @retval None
+ */
+void
+HD44780_Queue_Init(HD44780_Queue_t *Queue, HD44780_Handler_t *Handler);
+
+
+/**
+ * @brief  Post a single character to be displayed at specified position
+ * @note   This function never blocks and can be called from any context
+ *         (including ISRs) at the same time.
+ * @param  Queue: Pointer to queue
+ * @param  X: X position
+ * @param  Y: Y position
+ * @param  C: Character to display
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Queue is full.
+ */
+HD44780_Result_t
+HD44780_Queue_PostChar(HD44780_Queue_t *Queue, uint8_t X, uint8_t Y, char C);
+
+
+/**
+ * @brief  Post a short string to be displayed at specified position
+ * @note   This function never blocks and can be called from any context
+ *         (including ISRs) at the same time.
+ * @param  Queue: Pointer to queue
+ * @param  X: X position
+ * @param  Y: Y position
+ * @param  Str: String to display
+ * @param  Len: Length of string. If 0, string will be displayed until null
+ *              character.
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Queue is full or string is longer than
+ *                         HD44780_QUEUE_TEXT_MAX.
+ */
+HD44780_Result_t
+HD44780_Queue_PostString(HD44780_Queue_t *Queue, uint8_t X, uint8_t Y,
+                         const char *Str, uint8_t Len);
+
+
+/**
+ * @brief  Post a short string with a priority
+ * @note   Priority only matters in coalescing mode: when the budget of a
+ *         process call is spent, the remaining characters are written in
+ *         later calls, higher priorities first.
+ * @param  Queue: Pointer to queue
+ * @param  X: X position
+ * @param  Y: Y position
+ * @param  Str: String to display
+ * @param  Len: Length of string. If 0, string will be displayed until null
+ *              character.
+ * @param  Priority: Priority of the update (0 is the lowest, max 254)
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Queue is full or string is longer than
+ *                         HD44780_QUEUE_TEXT_MAX.
+ */
+HD44780_Result_t
+HD44780_Queue_PostPriority(HD44780_Queue_t *Queue, uint8_t X, uint8_t Y,
+                           const char *Str, uint8_t Len, uint8_t Priority);
+
+
+/**
+ * @brief  Post a short string to the urgent lane (e.g. an alarm message)
+ * @note   While HD44780_Queue_Process() is running, urgent entries are written
+ *         right after the byte currently being written, then routine work
+ *         resumes at its own cursor position. The worst-case latency is one
+ *         byte write plus the urgent entries posted before, or the period of
+ *         HD44780_Queue_Process() calls if it is not running. Urgent writes
+ *         are not limited by the budget of coalescing mode.
+ * @note   In coalescing mode, pending routine writes to the same cells are
+ *         dropped. Otherwise routine entries posted before may still
+ *         overwrite the urgent text.
+ * @param  Queue: Pointer to queue
+ * @param  X: X position
+ * @param  Y: Y position
+ * @param  Str: String to display
+ * @param  Len: Length of string. If 0, string will be displayed until null
+ *              character.
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Urgent lane is full or string is longer than
+ *                         HD44780_QUEUE_TEXT_MAX.
+ */
+HD44780_Result_t
+HD44780_Queue_PostUrgent(HD44780_Queue_t *Queue, uint8_t X, uint8_t Y,
+                         const char *Str, uint8_t Len);
+
+
+/**
+ * @brief  Enable coalescing mode
+ * @note   Repeated writes to the same cell overwrite each other before they
+ *         are written to the display. The bus time of each process call is
+ *         limited to BudgetUs, estimated with HD44780_GetCost() (execution
+ *         and transfer time of each write).
+ * @param  Queue: Pointer to queue
+ * @param  Pending: Buffer of Lines * Length characters
+ * @param  State: Buffer of Lines * Length bytes
+ * @param  BudgetUs: Bus time budget of each process call. If 0, all pending
+ *                   characters are written.
+ * @retval None
+ */
+void
+HD44780_Queue_SetCoalescing(HD44780_Queue_t *Queue,
+                            char *Pending, uint8_t *State, uint16_t BudgetUs);
+
+
+/**
+ * @brief  Write posted entries to the display
+ * @note   Only one context (the consumer) may call this function. Entries
+ *         posted while processing are left for the next call. In coalescing
+ *         mode, characters that do not fit in the budget are carried over.
+ * @param  Queue: Pointer to queue
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_Queue_Process(HD44780_Queue_t *Queue);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  //! _HD44780_QUEUE_H_
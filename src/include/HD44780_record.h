@@ -0,0 +1,147 @@
+/**
+ **********************************************************************************
+ * @file   HD44780_record.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Records public calls of HD44780 driver into a compact binary log
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _HD44780_RECORD_H_
+#define _HD44780_RECORD_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "HD44780.h"
+
+
+/* Functionality Options --------------------------------------------------------*/
+/**
+ * @brief  Size of the log in bytes. When the log is full, later calls are
+ *         dropped (and counted).
+ */
+#ifndef HD44780_RECORD_SIZE
+#define HD44780_RECORD_SIZE  512
+#endif
+
+
+/* Exported Constants -----------------------------------------------------------*/
+/**
+ * @brief  Log format
+ *         The log starts with "HDR" and the format version. Each call follows
+ *         as:
+ *         - Call (1 byte): HD44780_CALL_xx
+ *         - Time since previous call in microseconds: unsigned LEB128 (7 bits
+ *           per byte, least significant first, bit 7 set if more bytes follow)
+ *         - Size of arguments (1 byte, at most 255). The arguments of a
+ *           longer call are dropped (and counted).
+ *         - Arguments (see HD44780_CALL_xx in HD44780.h)
+ */
+#define HD44780_RECORD_VERSION  1
+#define HD44780_RECORD_HEADER   4
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  Call recorder data type
+ * @note   PlatformGetTimeUs is optional. If it is NULL, all times are 0.
+ */
+typedef struct HD44780_Record_s
+{
+  uint32_t (*PlatformGetTimeUs)(void);
+
+  uint32_t LastTime;
+  uint16_t Count;    // bytes used in Buffer
+  uint16_t Last;     // position of the argument size of the last call
+  uint16_t Dropped;  // calls that did not fit in Buffer or in 255 bytes
+  uint8_t Skip;      // last call was dropped
+  uint8_t Buffer[HD44780_RECORD_SIZE];
+} HD44780_Record_t;
+
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####                               
+ ==================================================================================
+ */
+
+/**
+ * @brief  Start recording public calls of the handler
+ * @note   Attach before HD44780_Init() to be able to replay the log. The log is
+ *         cleared. Requires HD44780_CONFIG_RECORD.
+ * @param  Record: Pointer to call recorder
+ * @param  Handler: Pointer to handler
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Handler is already recorded.
+ */
+HD44780_Result_t
+HD44780_Record_Attach(HD44780_Record_t *Record, HD44780_Handler_t *Handler);
+
+
+/**
+ * @brief  Stop recording public calls of the handler
+ * @param  Record: Pointer to call recorder
+ * @param  Handler: Pointer to handler
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Recorder is not attached to this handler.
+ */
+HD44780_Result_t
+HD44780_Record_Detach(HD44780_Record_t *Record, HD44780_Handler_t *Handler);
+
+
+/**
+ * @brief  Discard all recorded calls
+ * @param  Record: Pointer to call recorder
+ * @retval None
+ */
+void
+HD44780_Record_Clear(HD44780_Record_t *Record);
+
+
+/**
+ * @brief  Output the log (e.g. to a file or a serial port)
+ * @param  Record: Pointer to call recorder
+ * @param  Write: Function to output a piece of the log
+ * @retval None
+ */
+void
+HD44780_Record_Dump(const HD44780_Record_t *Record,
+                    void (*Write)(const uint8_t *Data, uint16_t Size));
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  //! _HD44780_RECORD_H_
@@ -0,0 +1,186 @@
+/**
+ **********************************************************************************
+ * @file   HD44780_trace.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Pin-level trace recorder for HD44780 driver with VCD export
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _HD44780_TRACE_H_
+#define _HD44780_TRACE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "HD44780.h"
+
+
+/* Functionality Options --------------------------------------------------------*/
+/**
+ * @brief  Number of events kept in the ring buffer. The oldest events are
+ *         overwritten when the buffer is full.
+ */
+#ifndef HD44780_TRACE_SIZE
+#define HD44780_TRACE_SIZE  256
+#endif
+
+
+/* Exported Constants -----------------------------------------------------------*/
+/**
+ * @brief  Traced signals
+ */
+#define HD44780_TRACE_RS    0 // register select
+#define HD44780_TRACE_RW    1 // read/write
+#define HD44780_TRACE_E     2 // enable strobe
+#define HD44780_TRACE_DATA  3 // D7..D4 as a 4-bit value
+#define HD44780_TRACE_DIR   4 // data direction (1: output)
+
+#define HD44780_TRACE_SIGNALS 5
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  A single recorded transition
+ */
+typedef struct HD44780_TraceEvent_s
+{
+  uint32_t Time;   // timestamp in nanoseconds, wraps after about 4.29 s
+  uint8_t Signal;  // HD44780_TRACE_xx
+  uint8_t Value;
+} HD44780_TraceEvent_t;
+
+/**
+ * @brief  Trace recorder data type
+ * @note   PlatformGetTimeNs is optional. If it is NULL, a virtual clock is
+ *         used which only advances by the delays requested by the driver. This
+ *         is useful on host builds where delays do not take real time.
+ */
+typedef struct HD44780_Trace_s
+{
+  // Platform of the wrapped handler
+  const HD44780_Ops_t *Ops;
+  void *Context;
+  // Platform functions installed in the handler
+  HD44780_Ops_t Wrapper;
+
+  uint32_t (*PlatformGetTimeNs)(void);
+
+  uint32_t VirtualTime;
+  uint16_t Head;
+  uint16_t Count;
+  HD44780_TraceEvent_t Events[HD44780_TRACE_SIZE];
+} HD44780_Trace_t;
+
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####                               
+ ==================================================================================
+ */
+
+#if !(HD44780_CONFIG_OPS_FLASH)
+/**
+ * @brief  Wrap platform functions of the handler with the trace recorder
+ * @note   Handler must be initialized by the platform before calling this
+ *         function. Each traced handler needs its own trace recorder.
+ * @note   Not available if HD44780_CONFIG_OPS_FLASH is 1, because the wrapper
+ *         table is built in RAM.
+ * @param  Trace: Pointer to trace recorder
+ * @param  Handler: Pointer to handler
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Handler has no platform or is already traced.
+ */
+HD44780_Result_t
+HD44780_Trace_Attach(HD44780_Trace_t *Trace, HD44780_Handler_t *Handler);
+
+
+/**
+ * @brief  Restore original platform functions of the handler
+ * @param  Trace: Pointer to trace recorder
+ * @param  Handler: Pointer to handler
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Trace is not attached to this handler.
+ */
+HD44780_Result_t
+HD44780_Trace_Detach(HD44780_Trace_t *Trace, HD44780_Handler_t *Handler);
+#endif
+
+
+/**
+ * @brief  Discard all recorded events
+ * @param  Trace: Pointer to trace recorder
+ * @retval None
+ */
+void
+HD44780_Trace_Clear(HD44780_Trace_t *Trace);
+
+
+/**
+ * @brief  Get a recorded event
+ * @param  Trace: Pointer to trace recorder
+ * @param  Index: Event index. 0 is the oldest event in the buffer.
+ * @retval Pointer to event or NULL if Index is out of range
+ */
+const HD44780_TraceEvent_t *
+HD44780_Trace_GetEvent(const HD44780_Trace_t *Trace, uint16_t Index);
+
+
+/**
+ * @brief  Find the shortest high pulse of a 1-bit signal in the buffer
+ * @param  Trace: Pointer to trace recorder
+ * @param  Signal: HD44780_TRACE_RS, HD44780_TRACE_RW or HD44780_TRACE_E
+ * @retval Pulse width in nanoseconds or UINT32_MAX if no complete pulse found
+ */
+uint32_t
+HD44780_Trace_MinPulseWidth(const HD44780_Trace_t *Trace, uint8_t Signal);
+
+
+/**
+ * @brief  Dump recorded events in Value Change Dump format (for GTKWave)
+ * @note   Dump times are summed from the gaps between events, so a capture
+ *         may be longer than the 4.29 s range of the event times as long as
+ *         no gap is.
+ * @param  Trace: Pointer to trace recorder
+ * @param  Write: Function to output null terminated pieces of the dump
+ * @retval None
+ */
+void
+HD44780_Trace_DumpVCD(const HD44780_Trace_t *Trace, void (*Write)(const char *));
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  //! _HD44780_TRACE_H_
@@ -0,0 +1,176 @@
+/**
+ **********************************************************************************
+ * @file   HD44780_utf8.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  UTF-8 text output with character ROM mapping and CGRAM fallback
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _HD44780_UTF8_H_
+#define _HD44780_UTF8_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "HD44780.h"
+
+
+/* Exported Constants -----------------------------------------------------------*/
+/**
+ * @brief  Character ROM codes
+ */
+#define HD44780_ROM_A00   0 // Japanese standard font
+#define HD44780_ROM_A02   1 // European standard font
+
+
+/* Functionality Options --------------------------------------------------------*/
+/**
+ * @brief  Character ROM of the module. The mapping tables are selected at
+ *         compile time.
+ */
+#ifndef HD44780_UTF8_ROM
+#define HD44780_UTF8_ROM  HD44780_ROM_A00
+#endif
+
+/**
+ * @brief  Character displayed for invalid sequences and for characters that
+ *         are neither in ROM nor in the bundled glyphs
+ */
+#ifndef HD44780_UTF8_REPLACEMENT
+#define HD44780_UTF8_REPLACEMENT  '?'
+#endif
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  UTF-8 output data type
+ */
+typedef struct HD44780_Utf8_s
+{
+  HD44780_Handler_t *Handler;
+
+  uint32_t Codepoint; // codepoint being decoded
+  uint8_t Remaining;  // continuation bytes left of current sequence
+  uint8_t Length;     // continuation bytes of current sequence
+  uint16_t Slots[8];  // codepoint of glyph loaded in each CGRAM location
+  uint8_t First;      // first CGRAM location used for glyphs
+  uint8_t Count;      // number of CGRAM locations used for glyphs
+} HD44780_Utf8_t;
+
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####                               
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize UTF-8 output
+ * @note   All CGRAM locations are used for glyphs. Use HD44780_Utf8_SetSlots()
+ *         to leave some of them to other modules (e.g. bar graphs).
+ * @param  Utf8: Pointer to UTF-8 output
+ * @param  Handler: Pointer to initialized handler
+ * @retval None
+ */
+void
+HD44780_Utf8_Init(HD44780_Utf8_t *Utf8, HD44780_Handler_t *Handler);
+
+
+/**
+ * @brief  Select the CGRAM locations used for glyphs
+ * @note   Locations outside First to First + Count - 1 are never written, so
+ *         they can be used by other modules. The selected locations are freed.
+ * @param  Utf8: Pointer to UTF-8 output
+ * @param  First: First CGRAM location
+ * @param  Count: Number of locations (0 to 8 - First)
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Locations are out of range.
+ */
+HD44780_Result_t
+HD44780_Utf8_SetSlots(HD44780_Utf8_t *Utf8, uint8_t First, uint8_t Count);
+
+
+/**
+ * @brief  Feed one byte of UTF-8 text
+ * @note   Characters missing from ROM are displayed using a bundled glyph,
+ *         uploaded to a free CGRAM location of the glyph slots on first use.
+ *         When all slots are used (or HD44780_CONFIG_CGRAM is 0),
+ *         HD44780_UTF8_REPLACEMENT is displayed instead, as for malformed
+ *         sequences (including overlong encodings and surrogates).
+ * @param  Utf8: Pointer to UTF-8 output
+ * @param  Byte: Next byte of text
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_Utf8_Putc(HD44780_Utf8_t *Utf8, char Byte);
+
+
+/**
+ * @brief  Display UTF-8 string
+ * @param  Utf8: Pointer to UTF-8 output
+ * @param  Str: Null terminated UTF-8 string
+ * @retval HD44780_Result_t
+ *         - HD44780_OK: Operation was successful.
+ *         - HD44780_FAIL: Failed to send or receive data.
+ */
+HD44780_Result_t
+HD44780_Utf8_Puts(HD44780_Utf8_t *Utf8, const char *Str);
+
+
+/**
+ * @brief  Free all CGRAM locations used for glyphs (e.g. on screen change)
+ * @note   Characters on the screen that use these locations change when the
+ *         locations are reused.
+ * @param  Utf8: Pointer to UTF-8 output
+ * @retval None
+ */
+void
+HD44780_Utf8_ResetGlyphs(HD44780_Utf8_t *Utf8);
+
+
+/**
+ * @brief  Map a codepoint to the character ROM
+ * @param  Codepoint: Unicode codepoint
+ * @retval Character code or 0 if the character is not in ROM
+ */
+uint8_t
+HD44780_Utf8_ToRom(uint16_t Codepoint);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  //! _HD44780_UTF8_H_
@@ -0,0 +1,625 @@
+/**
+ **********************************************************************************
+ * @file   replay.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Replays a call log of HD44780_record on a simulated module
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/**
+ * Usage: replay [-t] [-d] [-o ns] log.bin
+ *
+ *   -t     the module is write-only (PlatformReadData is NULL, timed mode)
+ *   -d     provide PlatformGetTimeUs (deadline based timed mode)
+ *   -o ns  cost of each platform call in nanoseconds (default 0)
+ *
+ * The calls of the log are replayed with their recorded idle gaps against a
+ * model of an HD44780U on a virtual clock. Total time spent inside the library,
+ * platform call counts, instructions, timing violations and the final visible
+ * screen are reported.
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "HD44780.h"
+#include "HD44780_record.h"
+
+
+
+/* Private Constants ------------------------------------------------------------*/
+#define INSTRUCTION_NS  37000UL    // most instructions and data write
+#define CLEAR_NS        1520000UL  // clear display and return home
+#define PULSE_NS        230UL      // minimum E high level width
+
+enum
+{
+  OP_INIT, OP_RS, OP_RW, OP_E, OP_DIR, OP_WRITE, OP_READ,
+  OP_DELAY_MS, OP_DELAY_US, OP_TIME, OP_COUNT
+};
+
+static const char *const OpNames[OP_COUNT] =
+{
+  "InitRsRwE", "SetValRs", "SetValRw", "SetValE", "SetDirData",
+  "WriteData", "ReadData", "DelayMs", "DelayUs", "GetTimeUs"
+};
+
+static const char *const CallNames[] =
+{
+  "?", "Init", "WarmInit", "Calibrate", "SetTimingPreset", "SetTiming",
+  "ClearScreen", "Home", "GoToXY", "SetPage", "ShowPage", "Putc", "Puts",
+  "Putv", "PutScreen_P", "Command", "Data", "CreateChar", "Scrub",
+  "PutStatic"
+};
+
+#define CALL_COUNT  (sizeof(CallNames) / sizeof(CallNames[0]))
+
+
+
+/* Private Variables ------------------------------------------------------------*/
+static struct
+{
+  uint64_t Now;          // virtual clock (ns)
+  uint64_t BusyUntil;
+  uint64_t RiseE;
+  uint32_t OverheadNs;
+  uint32_t Ops[OP_COUNT];
+  uint32_t Instructions;
+  uint32_t Violations;
+  uint8_t Rs, Rw, E, Bus;
+  uint8_t FourBit, Phase, Acc, Latched;
+  uint8_t Entry;
+  uint8_t Ac, CgMode, Shift;
+  uint8_t Ddram[128];
+  uint8_t Cgram[64];
+} Lcd;
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static void
+Lcd_Op(uint8_t Op)
+{
+  Lcd.Ops[Op]++;
+  Lcd.Now += Lcd.OverheadNs;
+}
+
+static void
+Lcd_StepAc(int8_t Dir)
+{
+  if (Lcd.CgMode)
+  {
+    Lcd.Ac = (Lcd.Ac + Dir) & 0x3F;
+    return;
+  }
+
+  if (Dir > 0)
+    Lcd.Ac = (Lcd.Ac == 0x27) ? 0x40 : (Lcd.Ac == 0x67) ? 0x00 : Lcd.Ac + 1;
+  else
+    Lcd.Ac = (Lcd.Ac == 0x00) ? 0x67 : (Lcd.Ac == 0x40) ? 0x27 : Lcd.Ac - 1;
+}
+
+static void
+Lcd_Execute(uint8_t Byte, uint8_t Data)
+{
+  uint64_t busy = INSTRUCTION_NS;
+
+  if (Lcd.Now < Lcd.BusyUntil)
+    Lcd.Violations++;
+  Lcd.Instructions++;
+
+  if (Data)
+  {
+    if (Lcd.CgMode)
+      Lcd.Cgram[Lcd.Ac & 0x3F] = Byte;
+    else
+      Lcd.Ddram[Lcd.Ac & 0x7F] = Byte;
+    Lcd_StepAc((Lcd.Entry & 0x02) ? 1 : -1);
+  }
+  else if (Byte & 0x80)
+  {
+    Lcd.Ac = Byte & 0x7F;
+    Lcd.CgMode = 0;
+  }
+  else if (Byte & 0x40)
+  {
+    Lcd.Ac = Byte & 0x3F;
+    Lcd.CgMode = 1;
+  }
+  else if (Byte & 0x20)
+  {
+    Lcd.FourBit = !(Byte & 0x10);
+  }
+  else if (Byte & 0x10)
+  {
+    if (Byte & 0x08)
+      Lcd.Shift = (Byte & 0x04) ? (Lcd.Shift + 39) % 40 : (Lcd.Shift + 1) % 40;
+    else
+      Lcd_StepAc((Byte & 0x04) ? 1 : -1);
+  }
+  else if (Byte & 0x08)
+  {
+    // display on/off control does not change the model
+  }
+  else if (Byte & 0x04)
+  {
+    Lcd.Entry = Byte;
+  }
+  else if (Byte & 0x02)
+  {
+    Lcd.Ac = Lcd.CgMode = Lcd.Shift = 0;
+    busy = CLEAR_NS;
+  }
+  else if (Byte & 0x01)
+  {
+    memset(Lcd.Ddram, ' ', sizeof(Lcd.Ddram));
+    Lcd.Ac = Lcd.CgMode = Lcd.Shift = 0;
+    Lcd.Entry |= 0x02;
+    busy = CLEAR_NS;
+  }
+
+  Lcd.BusyUntil = Lcd.Now + busy;
+}
+
+static uint8_t
+Lcd_Status(void)
+{
+  if (Lcd.Rs)
+    return Lcd.CgMode ? Lcd.Cgram[Lcd.Ac & 0x3F] : Lcd.Ddram[Lcd.Ac & 0x7F];
+
+  return ((Lcd.Now < Lcd.BusyUntil) ? 0x80 : 0) | (Lcd.Ac & 0x7F);
+}
+
+static void
+Lcd_Reset(void)
+{
+  uint32_t overhead = Lcd.OverheadNs;
+
+  memset(&Lcd, 0, sizeof(Lcd));
+  memset(Lcd.Ddram, ' ', sizeof(Lcd.Ddram));
+  Lcd.Entry = 0x06;
+  Lcd.OverheadNs = overhead;
+}
+
+
+static void
+Platform_InitRsRwE(void *Context)
+{
+  (void)Context;
+  Lcd_Op(OP_INIT);
+}
+
+static void
+Platform_SetValRs(void *Context, uint8_t Level)
+{
+  (void)Context;
+  Lcd_Op(OP_RS);
+  Lcd.Rs = !!Level;
+}
+
+static void
+Platform_SetValRw(void *Context, uint8_t Level)
+{
+  (void)Context;
+  Lcd_Op(OP_RW);
+  Lcd.Rw = !!Level;
+}
+
+static void
+Platform_SetValE(void *Context, uint8_t Level)
+{
+  (void)Context;
+  Lcd_Op(OP_E);
+  Level = !!Level;
+
+  if (Level && !Lcd.E)
+  {
+    Lcd.RiseE = Lcd.Now;
+    if (Lcd.Rw && (!Lcd.FourBit || Lcd.Phase == 0))
+      Lcd.Latched = Lcd_Status();
+  }
+  else if (!Level && Lcd.E)
+  {
+    if (Lcd.Now - Lcd.RiseE < PULSE_NS)
+      Lcd.Violations++;
+
+    if (Lcd.Rw)
+    {
+      if (Lcd.FourBit)
+      {
+        if (Lcd.Phase == 1 && Lcd.Rs)
+          Lcd_StepAc((Lcd.Entry & 0x02) ? 1 : -1);
+        Lcd.Phase ^= 1;
+      }
+    }
+    else if (!Lcd.FourBit)
+    {
+      Lcd_Execute(Lcd.Bus, Lcd.Rs);
+    }
+    else if (Lcd.Phase == 0)
+    {
+      Lcd.Acc = Lcd.Bus;
+      Lcd.Phase = 1;
+    }
+    else
+    {
+      Lcd.Phase = 0;
+      Lcd_Execute(Lcd.Acc | (Lcd.Bus >> 4), Lcd.Rs);
+    }
+  }
+
+  Lcd.E = Level;
+}
+
+static void
+Platform_SetDirData(void *Context, uint8_t Dir)
+{
+  (void)Context;
+  (void)Dir;
+  Lcd_Op(OP_DIR);
+}
+
+static void
+Platform_WriteData(void *Context, uint8_t Data)
+{
+  (void)Context;
+  Lcd_Op(OP_WRITE);
+  Lcd.Bus = Data & 0xF0;
+}
+
+static uint8_t
+Platform_ReadData(void *Context)
+{
+  (void)Context;
+  Lcd_Op(OP_READ);
+  if (Lcd.FourBit && Lcd.Phase == 1)
+    return (Lcd.Latched << 4) & 0xF0;
+
+  return Lcd.Latched & 0xF0;
+}
+
+static void
+Platform_DelayMs(void *Context, uint16_t Delay)
+{
+  (void)Context;
+  Lcd_Op(OP_DELAY_MS);
+  Lcd.Now += (uint64_t)Delay * 1000000;
+}
+
+static void
+Platform_DelayUs(void *Context, uint16_t Delay)
+{
+  (void)Context;
+  Lcd_Op(OP_DELAY_US);
+  Lcd.Now += (uint64_t)Delay * 1000;
+}
+
+static uint32_t
+Platform_GetTimeUs(void *Context)
+{
+  (void)Context;
+  Lcd_Op(OP_TIME);
+  return (uint32_t)(Lcd.Now / 1000);
+}
+
+
+static const char *
+Replay_Text(const uint8_t *Args, uint8_t Size, char *Text)
+{
+  memcpy(Text, Args, Size);
+  Text[Size] = 0;
+  return Text;
+}
+
+static HD44780_Result_t
+Replay_Call(HD44780_Handler_t *Handler, uint8_t Call,
+            const uint8_t *Args, uint8_t Size)
+{
+  char text[256];
+  HD44780_Timing_t timing;
+  HD44780_Segment_t segment;
+  uint16_t i;
+
+  // A log recorded after initialization can not be replayed
+  if (Handler->Lines == 0 && Call != HD44780_CALL_INIT &&
+      Call != HD44780_CALL_WARM_INIT && Call != HD44780_CALL_TIMING &&
+      Call != HD44780_CALL_TIMING_PRESET)
+  {
+    fprintf(stderr, "replay: call 0x%02X before initialization\n", Call);
+    return HD44780_FAIL;
+  }
+
+  switch (Call)
+  {
+  case HD44780_CALL_INIT:
+  case HD44780_CALL_WARM_INIT:
+    if (Size < 4)
+      break;
+    Handler->Options = Args[3];
+    Lcd_Reset();
+    if (Call == HD44780_CALL_INIT)
+      return HD44780_Init(Handler, Args[0], Args[1], Args[2]);
+    return HD44780_WarmInit(Handler, Args[0], Args[1], Args[2],
+                            Size > 4 ? Replay_Text(Args + 4, Size - 4, text) : NULL);
+
+  case HD44780_CALL_CALIBRATE:
+    return HD44780_Calibrate(Handler);
+
+  case HD44780_CALL_TIMING_PRESET:
+    if (Size < 1)
+      break;
+    return HD44780_SetTimingPreset(Handler, Args[0]);
+
+  case HD44780_CALL_TIMING:
+    if (Size < 15)
+      break;
+    timing.PowerOnMs = Args[0];
+    timing.EnablePulseUs = Args[1];
+    timing.EnableCycleUs = Args[2];
+    timing.AddressUs = Args[3];
+    timing.PollUs = Args[4];
+    timing.SyncUs = Args[5] | (Args[6] << 8);
+    timing.CommandUs = Args[7] | (Args[8] << 8);
+    timing.DataUs = Args[9] | (Args[10] << 8);
+    timing.ClearUs = Args[11] | (Args[12] << 8);
+    timing.HomeUs = Args[13] | (Args[14] << 8);
+    return HD44780_SetTiming(Handler, &timing);
+
+  case HD44780_CALL_CLEAR:
+    return HD44780_ClearScreen(Handler);
+
+  case HD44780_CALL_HOME:
+    return HD44780_Home(Handler);
+
+  case HD44780_CALL_GOTOXY:
+    if (Size < 2)
+      break;
+    return HD44780_GoToXY(Handler, Args[0], Args[1]);
+
+  case HD44780_CALL_SET_PAGE:
+    if (Size < 1)
+      break;
+    return HD44780_SetPage(Handler, Args[0]);
+
+  case HD44780_CALL_SHOW_PAGE:
+    if (Size < 1)
+      break;
+    return HD44780_ShowPage(Handler, Args[0]);
+
+  case HD44780_CALL_PUTC:
+    if (Size < 1)
+      break;
+    return HD44780_Putc(Handler, (char)Args[0]);
+
+  case HD44780_CALL_PUTS:
+    if (Size == 0)
+      return HD44780_OK;
+    return HD44780_Puts(Handler, Replay_Text(Args, Size, text), Size);
+
+  case HD44780_CALL_PUTV:
+    // Segment boundaries are not recorded, the text is written as one segment
+    if (Size < 3)
+      break;
+    segment.Str = Replay_Text(Args + 3, Size - 3, text);
+    segment.Len = Size - 3;
+    return HD44780_Putv(Handler, &segment, Size > 3, Args[0], Args[1], Args[2]);
+
+  case HD44780_CALL_PUT_SCREEN:
+    if (Size < Handler->Lines * Handler->Length)
+      break;
+    return HD44780_PutScreen_P(Handler, Replay_Text(Args, Size, text));
+
+  case HD44780_CALL_COMMAND:
+    if (Size < 1)
+      break;
+    return HD44780_Command(Handler, Args[0]);
+
+  case HD44780_CALL_DATA:
+    if (Size < 1)
+      break;
+    return HD44780_Data(Handler, Args[0]);
+
+  case HD44780_CALL_CREATE_CHAR:
+    if (Size < 9)
+      break;
+    return HD44780_CreateChar(Handler, Args[0], Args + 1);
+
+  case HD44780_CALL_SCRUB:
+    if (Size < 1)
+      break;
+    return HD44780_Scrub(Handler, Args[0]);
+
+  case HD44780_CALL_PUT_STATIC:
+    // Runs that were cut by the recorder are dropped
+    if (Size == 0)
+      break;
+    Replay_Text(Args, Size, text);
+    for (i = 0; text[i] != 0; i += 2 + (uint8_t)text[i])
+    {
+      if (i + 2 + (uint8_t)text[i] >= Size)
+      {
+        text[i] = 0;
+        break;
+      }
+    }
+    return HD44780_PutStatic(Handler, text);
+
+  default:
+    break;
+  }
+
+  fprintf(stderr, "replay: skipped call 0x%02X with %u bytes\n", Call, Size);
+  return HD44780_FAIL;
+}
+
+static void
+Replay_PrintScreen(HD44780_Handler_t *Handler)
+{
+  uint8_t line;
+  uint8_t x;
+  uint8_t c;
+
+  for (line = 0; line < Handler->Lines; line++)
+  {
+    putchar('|');
+    for (x = 0; x < Handler->Length; x++)
+    {
+      // Lines 3 and 4 start at HD44780_START_LINE3/4 whatever the length
+      c = Lcd.Ddram[(line & 1) * 0x40 +
+                    ((line >> 1) * 0x14 + x + Lcd.Shift) % 40];
+      putchar((c >= 0x20 && c < 0x7F) ? c : '?');
+    }
+    printf("|\n");
+  }
+}
+
+
+
+/**
+ ==================================================================================
+                              ##### Main Function #####                            
+ ==================================================================================
+ */
+
+int
+main(int argc, char *argv[])
+{
+  static uint8_t log[1 << 20];
+  HD44780_Ops_t ops =
+  {
+    Platform_InitRsRwE, Platform_SetValRs, Platform_SetValRw,
+    Platform_SetValE, Platform_SetDirData, Platform_WriteData,
+    Platform_ReadData, Platform_DelayMs, Platform_DelayUs,
+    NULL, NULL
+  };
+  HD44780_Handler_t handler = {0};
+  uint32_t calls[CALL_COUNT] = {0};
+  uint32_t failed = 0;
+  uint64_t start = 0;
+  uint64_t busTime = 0;
+  uint64_t recorded = 0;
+  size_t size;
+  size_t pos;
+  FILE *file;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "tdo:")) != -1)
+  {
+    switch (opt)
+    {
+    case 't': ops.PlatformReadData = NULL; break;
+    case 'd': ops.PlatformGetTimeUs = Platform_GetTimeUs; break;
+    case 'o': Lcd.OverheadNs = strtoul(optarg, NULL, 0); break;
+    default:
+      fprintf(stderr, "usage: %s [-t] [-d] [-o ns] log.bin\n", argv[0]);
+      return 2;
+    }
+  }
+
+  if (optind >= argc || (file = fopen(argv[optind], "rb")) == NULL)
+  {
+    fprintf(stderr, "usage: %s [-t] [-d] [-o ns] log.bin\n", argv[0]);
+    return 2;
+  }
+  size = fread(log, 1, sizeof(log), file);
+  fclose(file);
+
+  if (size < HD44780_RECORD_HEADER || memcmp(log, "HDR", 3) != 0 ||
+      log[3] != HD44780_RECORD_VERSION)
+  {
+    fprintf(stderr, "replay: %s is not a call log\n", argv[optind]);
+    return 1;
+  }
+
+  Lcd_Reset();
+  handler.Ops = &ops;
+
+  for (pos = HD44780_RECORD_HEADER; pos < size;)
+  {
+    uint8_t call = log[pos++];
+    uint64_t delta = 0;
+    uint8_t shift = 0;
+    uint8_t length;
+
+    do
+    {
+      if (pos >= size)
+        goto truncated;
+      delta |= (uint64_t)(log[pos] & 0x7F) << shift;
+      shift += 7;
+    } while (log[pos++] & 0x80);
+
+    if (pos >= size || pos + 1 + log[pos] > size)
+      goto truncated;
+    length = log[pos++];
+
+    // Idle time of the application between two calls
+    recorded += delta * 1000;
+    if (Lcd.Now < recorded)
+      Lcd.Now = recorded;
+
+    start = Lcd.Now;
+    if (Replay_Call(&handler, call, &log[pos], length) != HD44780_OK)
+      failed++;
+    busTime += Lcd.Now - start;
+    calls[call < CALL_COUNT ? call : 0]++;
+    pos += length;
+  }
+
+  goto report;
+
+truncated:
+  fprintf(stderr, "replay: log is truncated\n");
+
+report:
+  printf("calls:\n");
+  for (opt = 1; opt < (int)CALL_COUNT; opt++)
+    if (calls[opt])
+      printf("  %-16s %u\n", CallNames[opt], calls[opt]);
+  if (calls[0])
+    printf("  %-16s %u\n", "unknown", calls[0]);
+  printf("  %-16s %u\n", "failed", failed);
+
+  printf("platform calls:\n");
+  for (opt = 0; opt < OP_COUNT; opt++)
+    if (Lcd.Ops[opt])
+      printf("  %-16s %u\n", OpNames[opt], Lcd.Ops[opt]);
+
+  printf("instructions:      %u\n", Lcd.Instructions);
+  printf("violations:        %u\n", Lcd.Violations);
+  printf("time in library:   %llu us\n", (unsigned long long)(busTime / 1000));
+  printf("total time:        %llu us\n", (unsigned long long)(Lcd.Now / 1000));
+  printf("screen:\n");
+  Replay_PrintScreen(&handler);
+
+  return Lcd.Violations ? 1 : 0;
+}